@@ -5,17 +5,7 @@
 #include <iterator>
 #include <functional>
 #include "tiny_pair.h"
-
-// 编译器无力判别该类型
-template<class T>
-struct __type_traits {
-    typedef __true_type this_dummy_member_must_be_first;
-    typedef __true_type has_trivial_assignment_operator;
-    typedef __false_type has_trivial_default_constructor;
-    typedef __true_type has_trivial_copy_constructor;
-    typedef __true_type has_trivial_destructor;
-    typedef __false_type is_POD_type;
-};
+#include "tiny_type_traits.h"
 
 // 注意使用前必须判断两序列元素个数是否相同
 // 比较两个序列在[first,last)区间内是否相等
@@ -268,14 +258,13 @@ __copy_d(RandomAccessIter first, RandomAccessIter last,
 }
 
 template <class T>
-inline T* __copy_t(const T* first, const T* last, T* result, __true_type) {
+inline T* __copy_t(const T* first, const T* last, T* result, true_type) {
     memmove(result, first, sizeof(T) * (last - first));
     return result + (last - first);
 }
 
 template <class T>
-inline T* __copy_t(const T* first, const T* last, T* result, __false_type) {
-    memmove(result, first, sizeof(T) * (last - first));
+inline T* __copy_t(const T* first, const T* last, T* result, false_type) {
     return __copy_d(first, last, result, (ptrdiff_t *)0);
 }
 
@@ -331,7 +320,7 @@ inline BidirectionalIterator2 __copy_backward(BidirectionalIterator1 first,
 
 // 偏特化版本
 template <class T>
-struct __copy_backward_dispatch<T*, T*, __true_type>
+struct __copy_backward_dispatch<T*, T*, true_type>
 {
     static T* copy(const T* first, const T* last, T* result) {
         const ptrdiff_t Num = last - first;
@@ -341,10 +330,10 @@ struct __copy_backward_dispatch<T*, T*, __true_type>
 };
 
 template <class T>
-struct __copy_backward_dispatch<const T*, T*, __true_type>
+struct __copy_backward_dispatch<const T*, T*, true_type>
 {
     static T* copy(const T* first, const T* last, T* result) {
-        return  __copy_backward_dispatch<T*, T*, __true_type>
+        return  __copy_backward_dispatch<T*, T*, true_type>
         ::copy(first, last, result);
     }
 };
@@ -2,26 +2,936 @@
 #define __TINY_ALLOC_H
 
 #include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <mutex>
+#include <atomic>
+#include <cstdio>
 #include <malloc.h>
 
+// Linux下超大区块改用mmap配置，定义__TINY_NO_MMAP可关闭
+#if defined(__linux__) && !defined(__TINY_NO_MMAP)
+#   define __TINY_USE_MMAP
+#   include <sys/mman.h>
+#   include <unistd.h>
+#endif
+
 using namespace std;
-template<class T>
-class simple_alloc {
 
+// 默认情况下node allocator以互斥锁保护自由链表
+// 若确定只在单线程下使用，可定义__TINY_NO_THREADS以去掉加锁开销
+#ifdef __TINY_NO_THREADS
+#   define __NODE_ALLOCATOR_THREADS false
+#else
+#   define __NODE_ALLOCATOR_THREADS true
+#endif
+
+#define __THROW_BAD_ALLOC throw std::bad_alloc()
+
+// 把可用大小n(bytes)按unit向下取整，供allocate_at_least()使用
+// unit是调用者的元素大小，取整后释放时传回的大小与配置所得一致
+inline size_t __round_down(size_t n, size_t unit) { return n - n % unit; }
+
+// malloc实际给出的区块大小，平台不提供时返回0
+inline size_t __malloc_usable_size(void *p) {
+#if defined(__GLIBC__)
+    return malloc_usable_size(p);
+#elif defined(_WIN32)
+    return _msize(p);
+#else
+    return 0;
+#endif
+}
+
+// 不小于此值(bytes)的区块以mmap配置并建议内核使用透明大页，
+// 以减少扫描超大vector时的TLB miss；释放与扩充时同样依大小分派，
+// 因此门槛只能在编译期决定
+#ifndef __TINY_MMAP_THRESHOLD
+#   define __TINY_MMAP_THRESHOLD ((size_t)64 << 20)
+#endif
+
+#ifdef __TINY_USE_MMAP
+inline size_t __page_round_up(size_t n) {
+    static const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    return (n + page - 1) & ~(page - 1);
+}
+
+inline bool __use_mmap(size_t n) { return n >= __TINY_MMAP_THRESHOLD; }
+#else
+inline bool __use_mmap(size_t) { return false; }
+#endif
+
+// 第一级配置器：直接使用malloc/free/realloc，超大区块使用mmap/munmap/mremap
+// 内存不足时调用用户设定的oom handler，未设定则抛出bad_alloc
+template <int inst>
+class __malloc_alloc_template {
+
+private:
+    // 以下函数用来处理内存不足的情况
+    static void *oom_malloc(size_t);
+    static void *oom_realloc(void *, size_t);
+    static void (*__malloc_alloc_oom_handler)();
+
+#ifdef __TINY_USE_MMAP
+    static void* mmap_allocate(size_t n) {
+        void *result = mmap(0, __page_round_up(n), PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (MAP_FAILED == result)
+            __THROW_BAD_ALLOC;
+#ifdef MADV_HUGEPAGE
+        madvise(result, __page_round_up(n), MADV_HUGEPAGE);
+#endif
+        return result;
+    }
+    static void mmap_deallocate(void *p, size_t n) {
+        munmap(p, __page_round_up(n));
+    }
+    // 新旧区块都以mmap配置：mremap只改动页表，不复制内容
+    static void* mmap_reallocate(void *p, size_t old_sz, size_t new_sz) {
+        void *result = mremap(p, __page_round_up(old_sz), __page_round_up(new_sz), MREMAP_MAYMOVE);
+        if (MAP_FAILED == result)
+            __THROW_BAD_ALLOC;
+#ifdef MADV_HUGEPAGE
+        madvise(result, __page_round_up(new_sz), MADV_HUGEPAGE);
+#endif
+        return result;
+    }
+#endif
+
+public:
+    static void* allocate(size_t n) {
+#ifdef __TINY_USE_MMAP
+        if (__use_mmap(n))
+            return mmap_allocate(n);
+#endif
+        void *result = malloc(n);   // 第一级配置器直接使用malloc()
+        // 以下无法满足需求时，改用oom_malloc()
+        if (0 == result)
+            result = oom_malloc(n);
+        return result;
+    }
+    static void deallocate(void *p, size_t n) {
+#ifdef __TINY_USE_MMAP
+        if (__use_mmap(n)) {
+            mmap_deallocate(p, n);
+            return;
+        }
+#endif
+        free(p);    // 第一级配置器直接使用free()
+    }
+    // 配置至少n bytes，并把n改为实际可用的大小(按unit向下取整)
+    // malloc的size class常比需求大，多出的部分也交给调用者使用
+    // 调整后的n不可跨过mmap门槛，否则释放时会被分派到另一条路径
+    static void* allocate_at_least(size_t &n, size_t unit = 1) {
+        void *result = allocate(n);
+        size_t usable;
+#ifdef __TINY_USE_MMAP
+        if (__use_mmap(n))
+            // 整页都可使用；unit大于一页时按unit取整可能少算整页，保持n不变
+            usable = unit <= __page_round_up(1) ? __round_down(__page_round_up(n), unit) : n;
+        else {
+            usable = __malloc_usable_size(result);
+            if (__use_mmap(usable))
+                usable = __TINY_MMAP_THRESHOLD - 1;
+            usable = __round_down(usable, unit);
+        }
+#else
+        usable = __round_down(__malloc_usable_size(result), unit);
+#endif
+        if (usable > n)
+            n = usable;
+        return result;
+    }
+    static void* reallocate(void *p, size_t old_sz, size_t new_sz) {
+#ifdef __TINY_USE_MMAP
+        if (__use_mmap(old_sz) && __use_mmap(new_sz))
+            return mmap_reallocate(p, old_sz, new_sz);
+        if (__use_mmap(old_sz) || __use_mmap(new_sz)) {
+            // 跨过门槛：配置新区块，复制后释放旧区块
+            void *result = allocate(new_sz);
+            memcpy(result, p, old_sz < new_sz ? old_sz : new_sz);
+            deallocate(p, old_sz);
+            return result;
+        }
+#endif
+        void *result = realloc(p, new_sz);  // 第一级配置器直接使用realloc()
+        // 以下无法满足需求时，改用oom_realloc()
+        if (0 == result)
+            result = oom_realloc(p, new_sz);
+        return result;
+    }
+    // 以下仿真C++的set_new_handler()，可以通过它指定自己的oom handler
+    static void (*set_malloc_handler(void (*f)()))() {
+        void (*old)() = __malloc_alloc_oom_handler;
+        __malloc_alloc_oom_handler = f;
+        return old;
+    }
+};
+
+// malloc_alloc out-of-memory handling，初值为0，由客端设定
+template <int inst>
+void (*__malloc_alloc_template<inst>::__malloc_alloc_oom_handler)() = 0;
+
+template <int inst>
+void* __malloc_alloc_template<inst>::oom_malloc(size_t n) {
+    void (*my_malloc_handler)();
+    void *result;
+    for (;;) {      // 不断尝试释放、配置、再释放、再配置...
+        my_malloc_handler = __malloc_alloc_oom_handler;
+        if (0 == my_malloc_handler)
+            __THROW_BAD_ALLOC;
+        (*my_malloc_handler)();     // 调用处理例程，企图释放内存
+        result = malloc(n);         // 再次尝试配置内存
+        if (result)
+            return result;
+    }
+}
+
+template <int inst>
+void* __malloc_alloc_template<inst>::oom_realloc(void *p, size_t n) {
+    void (*my_malloc_handler)();
+    void *result;
+    for (;;) {      // 不断尝试释放、配置、再释放、再配置...
+        my_malloc_handler = __malloc_alloc_oom_handler;
+        if (0 == my_malloc_handler)
+            __THROW_BAD_ALLOC;
+        (*my_malloc_handler)();     // 调用处理例程，企图释放内存
+        result = realloc(p, n);     // 再次尝试配置内存
+        if (result)
+            return result;
+    }
+}
+
+// 注意，以下直接将参数inst指定为0
+typedef __malloc_alloc_template<0> malloc_alloc;
+
+enum { __ALIGN = 8 };       // 小型区块的上调边界
+enum { __MAX_BYTES = 128 };     // 小型区块的上限
+enum { __NFREELISTS = (int)__MAX_BYTES / __ALIGN };      // free-lists个数
+
+// 第二级配置器：以内存池管理小型区块
+// 大于128 bytes的区块交给第一级配置器，否则从16个free-lists中取用
+// 第一参数用于多线程环境，第二参数完全没派上用场
+template <bool threads, int inst>
+class __default_alloc_template {
+
+private:
+    // ROUND_UP()将bytes上调至8的倍数
+    static size_t ROUND_UP(size_t bytes) {
+        return (((bytes) + __ALIGN - 1) & ~((size_t)__ALIGN - 1));
+    }
+
+private:
+    union obj {     // free-lists的节点构造
+        union obj *free_list_link;
+        char client_data[1];
+    };
+
+private:
+    // 16个free-lists
+    static obj *volatile free_list[__NFREELISTS];
+    // 以下函数根据区块大小，决定使用第n号free-list，n从0起算
+    static size_t FREELIST_INDEX(size_t bytes) {
+        return (((bytes) + __ALIGN - 1) / __ALIGN - 1);
+    }
+
+    // 返回一个大小为n的对象，并可能加入大小为n的其他区块到free-list
+    static void *refill(size_t n);
+    // 配置一大块空间，可容纳nobjs个大小为size的区块
+    // 如果配置nobjs个区块有所不便，nobjs可能会降低
+    static char *chunk_alloc(size_t size, int &nobjs);
+
+    // Chunk allocation state
+    static char *start_free;    // 内存池起始位置，只在chunk_alloc()中变化
+    static char *end_free;      // 内存池结束位置，只在chunk_alloc()中变化
+    static size_t heap_size;
+
+    // 多线程环境下保护free-lists与内存池
+    static std::mutex __node_allocator_lock;
+
+    class lock {
+        public:
+            lock() { if (threads) __node_allocator_lock.lock(); }
+            ~lock() { if (threads) __node_allocator_lock.unlock(); }
+    };
+    friend class lock;
+
+public:
+    static void* allocate(size_t n);
+    static void deallocate(void *p, size_t n);
+    static void* reallocate(void *p, size_t old_sz, size_t new_sz);
+    // 小区块实际占用上调至8的倍数的大小，把多出的部分也交给调用者
+    static void* allocate_at_least(size_t &n, size_t unit = 1) {
+        if (n > (size_t)__MAX_BYTES)
+            return malloc_alloc::allocate_at_least(n, unit);
+        n = __round_down(ROUND_UP(n), unit);
+        return allocate(n);
+    }
+};
+
+// 以下是static data member的定义与初值设定
+template <bool threads, int inst>
+char *__default_alloc_template<threads, inst>::start_free = 0;
+
+template <bool threads, int inst>
+char *__default_alloc_template<threads, inst>::end_free = 0;
+
+template <bool threads, int inst>
+size_t __default_alloc_template<threads, inst>::heap_size = 0;
+
+template <bool threads, int inst>
+typename __default_alloc_template<threads, inst>::obj *volatile
+__default_alloc_template<threads, inst>::free_list[__NFREELISTS] =
+    {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+
+template <bool threads, int inst>
+std::mutex __default_alloc_template<threads, inst>::__node_allocator_lock;
+
+// n必须大于0
+template <bool threads, int inst>
+void* __default_alloc_template<threads, inst>::allocate(size_t n) {
+    obj *volatile *my_free_list;
+    obj *result;
+    // 大于128就调用第一级配置器
+    if (n > (size_t)__MAX_BYTES)
+        return malloc_alloc::allocate(n);
+    // 寻找16个free-lists中适当的一个
+    my_free_list = free_list + FREELIST_INDEX(n);
+    lock lock_instance;     // 离开作用域时自动解锁
+    result = *my_free_list;
+    if (result == 0) {
+        // 没找到可用的free-list，准备重新填充free-list
+        void *r = refill(ROUND_UP(n));
+        return r;
+    }
+    // 调整free-list
+    *my_free_list = result->free_list_link;
+    return result;
+}
+
+// p不可以是0
+template <bool threads, int inst>
+void __default_alloc_template<threads, inst>::deallocate(void *p, size_t n) {
+    obj *q = (obj *)p;
+    obj *volatile *my_free_list;
+    // 大于128就调用第一级配置器
+    if (n > (size_t)__MAX_BYTES) {
+        malloc_alloc::deallocate(p, n);
+        return;
+    }
+    // 寻找对应的free-list
+    my_free_list = free_list + FREELIST_INDEX(n);
+    lock lock_instance;
+    // 调整free-list，回收区块
+    q->free_list_link = *my_free_list;
+    *my_free_list = q;
+}
+
+template <bool threads, int inst>
+void* __default_alloc_template<threads, inst>::reallocate(void *p, size_t old_sz, size_t new_sz) {
+    void *result;
+    size_t copy_sz;
+    // 新旧区块都大于128，直接交给realloc()
+    if (old_sz > (size_t)__MAX_BYTES && new_sz > (size_t)__MAX_BYTES)
+        return malloc_alloc::reallocate(p, old_sz, new_sz);
+    // 落在同一个free-list，不必搬动
+    if (ROUND_UP(old_sz) == ROUND_UP(new_sz))
+        return p;
+    result = allocate(new_sz);
+    copy_sz = new_sz > old_sz ? old_sz : new_sz;
+    memcpy(result, p, copy_sz);
+    deallocate(p, old_sz);
+    return result;
+}
+
+// 返回一个大小为n的对象，并且有时候会为适当的free-list增加节点
+// 假设n已经适当上调至8的倍数，调用者已持有锁
+template <bool threads, int inst>
+void* __default_alloc_template<threads, inst>::refill(size_t n) {
+    int nobjs = 20;
+    // 调用chunk_alloc()，尝试取得nobjs个区块作为free-list的新节点
+    // 注意参数nobjs是pass by reference
+    char *chunk = chunk_alloc(n, nobjs);
+    obj *volatile *my_free_list;
+    obj *result;
+    obj *current_obj, *next_obj;
+    int i;
+
+    // 如果只获得一个区块，这个区块就分配给调用者用，free-list无新节点
+    if (1 == nobjs)
+        return chunk;
+    // 否则准备调整free-list，纳入新节点
+    my_free_list = free_list + FREELIST_INDEX(n);
+
+    // 以下在chunk空间内建立free-list
+    result = (obj *)chunk;      // 这一块准备返回给客端
+    // 以下导引free-list指向新配置的空间(取自内存池)
+    *my_free_list = next_obj = (obj *)(chunk + n);
+    // 以下将free-list的各节点串接起来
+    for (i = 1; ; i++) {    // 从1开始，因为第0个将返回给客端
+        current_obj = next_obj;
+        next_obj = (obj *)((char *)next_obj + n);
+        if (nobjs - 1 == i) {
+            current_obj->free_list_link = 0;
+            break;
+        }
+        else {
+            current_obj->free_list_link = next_obj;
+        }
+    }
+    return result;
+}
+
+// 假设size已经适当上调至8的倍数，调用者已持有锁
+// 注意参数nobjs是pass by reference
+template <bool threads, int inst>
+char* __default_alloc_template<threads, inst>::chunk_alloc(size_t size, int &nobjs) {
+    char *result;
+    size_t total_bytes = size * nobjs;
+    size_t bytes_left = end_free - start_free;  // 内存池剩余空间
+
+    if (bytes_left >= total_bytes) {
+        // 内存池剩余空间完全满足需求量
+        result = start_free;
+        start_free += total_bytes;
+        return result;
+    }
+    else if (bytes_left >= size) {
+        // 内存池剩余空间不能完全满足需求量，但足够供应一个(含)以上的区块
+        nobjs = (int)(bytes_left / size);
+        total_bytes = size * nobjs;
+        result = start_free;
+        start_free += total_bytes;
+        return result;
+    }
+    else {
+        // 内存池剩余空间连一个区块的大小都无法提供
+        size_t bytes_to_get = 2 * total_bytes + ROUND_UP(heap_size >> 4);
+        // 以下试着让内存池中的残余零头还有利用价值
+        if (bytes_left > 0) {
+            // 内存池内还有一些零头，先配给适当的free-list
+            // 首先寻找适当的free-list
+            obj *volatile *my_free_list = free_list + FREELIST_INDEX(bytes_left);
+            // 调整free-list，将内存池中的残余空间编入
+            ((obj *)start_free)->free_list_link = *my_free_list;
+            *my_free_list = (obj *)start_free;
+        }
+
+        // 配置heap空间，用来补充内存池
+        start_free = (char *)malloc(bytes_to_get);
+        if (0 == start_free) {
+            // heap空间不足，malloc()失败
+            int i;
+            obj *volatile *my_free_list, *p;
+            // 试着检视我们手上拥有的东西，这不会造成伤害
+            // 我们不打算尝试配置较小的区块，因为那在多进程机器上容易导致灾难
+            // 以下搜寻适当的free-list，所谓适当是指尚有未用区块，且区块够大
+            for (i = (int)size; i <= __MAX_BYTES; i += __ALIGN) {
+                my_free_list = free_list + FREELIST_INDEX(i);
+                p = *my_free_list;
+                if (0 != p) {   // free-list内尚有未用区块
+                    // 调整free-list以释出未用区块
+                    *my_free_list = p->free_list_link;
+                    start_free = (char *)p;
+                    end_free = start_free + i;
+                    // 递归调用自己，为了修正nobjs
+                    return chunk_alloc(size, nobjs);
+                    // 注意，任何残余零头终将被编入适当的free-list中备用
+                }
+            }
+            end_free = 0;   // 如果出现意外(山穷水尽，到处都没内存可用了)
+            // 调用第一级配置器，看看oom机制能否尽点力
+            start_free = (char *)malloc_alloc::allocate(bytes_to_get);
+            // 这会导致抛出异常，或内存不足的情况获得改善
+        }
+        heap_size += bytes_to_get;
+        end_free = start_free + bytes_to_get;
+        // 递归调用自己，为了修正nobjs
+        return chunk_alloc(size, nobjs);
+    }
+}
+
+// 单线程版本，供确定不会跨线程使用的容器选用
+typedef __default_alloc_template<false, 0> single_client_alloc;
+
+enum { __MAGAZINE_ROUNDS = 32 };    // 每个magazine可容纳的区块数
+
+// 线程本地的magazine缓存，架在加锁的第二级配置器之上
+// 每个线程对每个free-list持有两个magazine(loaded和previous)
+// 绝大多数配置与释放只在本线程的magazine中进行，完全不必加锁
+// 只有两个magazine都空(或都满)时，才以整个magazine为单位与共享的depot交换
+// 在某线程配置、于另一线程释放的区块，会进入释放线程的magazine，
+// 满了之后整批归还depot，任何线程都可以再取用；线程结束时缓存全部归还depot
+// 缓存析构之后(例如更晚析构的thread_local对象、程序结束时析构的static对象)
+// 本线程的配置与释放直接交给加锁的第二级配置器
+template <int inst>
+class __magazine_alloc_template {
+
+private:
+    typedef __default_alloc_template<true, inst> pool_alloc;
+
+    struct magazine {
+        magazine *next;     // depot中串接magazine之用
+        size_t rounds;      // 目前持有的区块数
+        void *round[__MAGAZINE_ROUNDS];
+    };
+
+    // depot：每个free-list各有一串满magazine与一串空magazine
+    struct depot {
+        magazine *full;
+        magazine *empty;
+        std::mutex lock;
+    };
+    static depot depots[__NFREELISTS];
+
+    // 每个线程的缓存，线程结束时由析构函数把magazine交回depot并清空，
+    // 此后loaded恒为0，配置与释放都会走到慢路径，由torn_down转给第二级配置器
+    struct thread_cache {
+        magazine *loaded[__NFREELISTS];
+        magazine *previous[__NFREELISTS];
+        // constexpr使缓存静态初始化：若其他thread_local对象的构造先用到了缓存，
+        // 动态初始化会在之后把已装上的magazine清掉
+        constexpr thread_cache() : loaded(), previous() {}
+        ~thread_cache() {
+            torn_down = true;
+            for (int i = 0; i < __NFREELISTS; ++i) {
+                depot_return(i, loaded[i]);
+                depot_return(i, previous[i]);
+                loaded[i] = previous[i] = 0;
+            }
+        }
+    };
+    static thread_local thread_cache cache;
+    // 本线程的缓存是否已析构；bool无需动态初始化与析构，缓存析构后仍可读取
+    static thread_local bool torn_down;
+
+    static size_t FREELIST_INDEX(size_t bytes) {
+        return (((bytes) + __ALIGN - 1) / __ALIGN - 1);
+    }
+
+    static magazine *new_magazine() {
+        magazine *m = (magazine *)malloc_alloc::allocate(sizeof(magazine));
+        m->next = 0;
+        m->rounds = 0;
+        return m;
+    }
+
+    // 把一个magazine交回depot，依其是否持有区块挂到full或empty串行
+    static void depot_return(size_t index, magazine *m) {
+        if (0 == m)
+            return;
+        depot &d = depots[index];
+        std::lock_guard<std::mutex> guard(d.lock);
+        if (m->rounds != 0) {
+            m->next = d.full;
+            d.full = m;
+        }
+        else {
+            m->next = d.empty;
+            d.empty = m;
+        }
+    }
+
+    static void *allocate_slow(size_t index);
+    static void deallocate_slow(void *p, size_t index);
+
+public:
+    static void* allocate(size_t n) {
+        // 大于128就调用第一级配置器
+        if (n > (size_t)__MAX_BYTES)
+            return malloc_alloc::allocate(n);
+        size_t index = FREELIST_INDEX(n);
+        magazine *m = cache.loaded[index];
+        if (m != 0 && m->rounds != 0)
+            return m->round[--m->rounds];
+        return allocate_slow(index);
+    }
+    static void deallocate(void *p, size_t n) {
+        // 大于128就调用第一级配置器
+        if (n > (size_t)__MAX_BYTES) {
+            malloc_alloc::deallocate(p, n);
+            return;
+        }
+        size_t index = FREELIST_INDEX(n);
+        magazine *m = cache.loaded[index];
+        if (m != 0 && m->rounds != __MAGAZINE_ROUNDS) {
+            m->round[m->rounds++] = p;
+            return;
+        }
+        deallocate_slow(p, index);
+    }
+    static void* allocate_at_least(size_t &n, size_t unit = 1) {
+        if (n > (size_t)__MAX_BYTES)
+            return malloc_alloc::allocate_at_least(n, unit);
+        n = __round_down((n + __ALIGN - 1) & ~((size_t)__ALIGN - 1), unit);
+        return allocate(n);
+    }
+    static void* reallocate(void *p, size_t old_sz, size_t new_sz) {
+        // 新旧区块都大于128，直接交给realloc()
+        if (old_sz > (size_t)__MAX_BYTES && new_sz > (size_t)__MAX_BYTES)
+            return malloc_alloc::reallocate(p, old_sz, new_sz);
+        void *result = allocate(new_sz);
+        memcpy(result, p, new_sz > old_sz ? old_sz : new_sz);
+        deallocate(p, old_sz);
+        return result;
+    }
+};
+
+template <int inst>
+typename __magazine_alloc_template<inst>::depot
+__magazine_alloc_template<inst>::depots[__NFREELISTS];
+
+template <int inst>
+thread_local typename __magazine_alloc_template<inst>::thread_cache
+__magazine_alloc_template<inst>::cache;
+
+template <int inst>
+thread_local bool __magazine_alloc_template<inst>::torn_down = false;
+
+// loaded已空：先换用previous，再向depot换一个满的magazine，
+// depot也没有时，整批向第二级配置器取区块
+template <int inst>
+void* __magazine_alloc_template<inst>::allocate_slow(size_t index) {
+    if (torn_down)
+        return pool_alloc::allocate((index + 1) * __ALIGN);
+    magazine *&loaded = cache.loaded[index];
+    magazine *&previous = cache.previous[index];
+    if (previous != 0 && previous->rounds != 0) {
+        std::swap(loaded, previous);
+        return loaded->round[--loaded->rounds];
+    }
+    {
+        depot &d = depots[index];
+        std::lock_guard<std::mutex> guard(d.lock);
+        if (d.full != 0) {
+            magazine *full = d.full;
+            d.full = full->next;
+            // 空的previous归还depot，loaded降为previous
+            if (previous != 0) {
+                previous->next = d.empty;
+                d.empty = previous;
+            }
+            previous = loaded;
+            loaded = full;
+            return loaded->round[--loaded->rounds];
+        }
+    }
+    // depot中也没有可用区块，向第二级配置器配置半个magazine
+    if (loaded == 0)
+        loaded = new_magazine();
+    size_t bytes = (index + 1) * __ALIGN;
+    for (int i = 0; i < __MAGAZINE_ROUNDS / 2; ++i)
+        loaded->round[loaded->rounds++] = pool_alloc::allocate(bytes);
+    return loaded->round[--loaded->rounds];
+}
+
+// loaded已满：先换用previous，再把满的previous交给depot并换一个空magazine
+template <int inst>
+void __magazine_alloc_template<inst>::deallocate_slow(void *p, size_t index) {
+    if (torn_down) {
+        pool_alloc::deallocate(p, (index + 1) * __ALIGN);
+        return;
+    }
+    magazine *&loaded = cache.loaded[index];
+    magazine *&previous = cache.previous[index];
+    if (loaded == 0) {
+        loaded = new_magazine();
+        loaded->round[loaded->rounds++] = p;
+        return;
+    }
+    if (previous == 0 || previous->rounds == 0) {
+        if (previous == 0)
+            previous = new_magazine();
+        std::swap(loaded, previous);
+        loaded->round[loaded->rounds++] = p;
+        return;
+    }
+    magazine *empty = 0;
+    {
+        depot &d = depots[index];
+        std::lock_guard<std::mutex> guard(d.lock);
+        // 满的previous整批归还depot
+        previous->next = d.full;
+        d.full = previous;
+        if (d.empty != 0) {
+            empty = d.empty;
+            d.empty = empty->next;
+        }
+    }
+    if (0 == empty)
+        empty = new_magazine();
+    previous = loaded;
+    loaded = empty;
+    loaded->round[loaded->rounds++] = p;
+}
+
+// 未加统计的默认配置器
+// 多线程环境下是带线程本地缓存的版本，否则就是第二级配置器本身
+#ifdef __TINY_NO_THREADS
+typedef single_client_alloc __plain_alloc;
+#else
+typedef __magazine_alloc_template<0> __plain_alloc;
+#endif
+
+// 配置器的deallocate()是否为空操作(例如只在整体release时才归还的arena)
+// 默认不是，有此性质的配置器以非模板的重载版本覆盖，由ADL找到
+template <class Alloc>
+inline bool __deallocate_is_noop(const Alloc&) { return false; }
+
+// 配置器提供allocate_at_least()时使用之，n改为实际可用的bytes
+// 否则退回allocate()，n保持不变
+template <class Alloc>
+inline auto __allocate_at_least(Alloc &a, size_t &n, size_t unit, int)
+    -> decltype(a.allocate_at_least(n, unit)) {
+    return a.allocate_at_least(n, unit);
+}
+
+template <class Alloc>
+inline void* __allocate_at_least(Alloc &a, size_t &n, size_t, long) {
+    return a.allocate(n);
+}
+
+// 配置器提供reallocate()时使用之，否则配置新区块、复制后释放旧区块
+// 内容以bytes搬移，只适用于可逐位复制的元素
+template <class Alloc>
+inline auto __reallocate(Alloc &a, void *p, size_t old_sz, size_t new_sz, int)
+    -> decltype(a.reallocate(p, old_sz, new_sz)) {
+    return a.reallocate(p, old_sz, new_sz);
+}
+
+template <class Alloc>
+inline void* __reallocate(Alloc &a, void *p, size_t old_sz, size_t new_sz, long) {
+    void *result = a.allocate(new_sz);
+    memcpy(result, p, old_sz < new_sz ? old_sz : new_sz);
+    a.deallocate(p, old_sz);
+    return result;
+}
+
+// 以下是配置统计：traced_alloc<Tag, Alloc>包装任一配置器，
+// 按Tag累计存活字节、峰值字节、配置/释放次数以及区块大小分布
+// Tag是任意型别，须提供static const char* name()
+
+// 大小分布以2的幂分级：第i级计入(2^(i-1), 2^i]字节的需求，最后一级收纳更大的
+enum { __ALLOC_HISTOGRAM_BUCKETS = 32 };
+
+// 某一Tag在某一时刻的统计快照
+struct alloc_stats_snapshot {
+    const char *tag;
+    size_t live_bytes;
+    size_t peak_bytes;
+    size_t alloc_count;
+    size_t free_count;
+    size_t histogram[__ALLOC_HISTOGRAM_BUCKETS];
+};
+
+// 每个Tag一份统计，首次使用时构造并挂入全局链表
+class __alloc_stats {
+public:
+    explicit __alloc_stats(const char *tag) : tag_(tag), live_(0), peak_(0), allocs_(0), frees_(0) {
+        for (int i = 0; i < __ALLOC_HISTOGRAM_BUCKETS; ++i)
+            histogram_[i].store(0, std::memory_order_relaxed);
+        // 无锁地插入链表头，链表只增不减
+        next_ = head().load(std::memory_order_relaxed);
+        while (!head().compare_exchange_weak(next_, this, std::memory_order_release,
+                                             std::memory_order_relaxed))
+            ;
+    }
+
+    void record_alloc(size_t n) {
+        size_t live = live_.fetch_add(n, std::memory_order_relaxed) + n;
+        size_t peak = peak_.load(std::memory_order_relaxed);
+        while (live > peak && !peak_.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+            ;
+        allocs_.fetch_add(1, std::memory_order_relaxed);
+        histogram_[bucket(n)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void record_free(size_t n) {
+        live_.fetch_sub(n, std::memory_order_relaxed);
+        frees_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    alloc_stats_snapshot snapshot() const {
+        alloc_stats_snapshot s;
+        s.tag = tag_;
+        s.live_bytes = live_.load(std::memory_order_relaxed);
+        s.peak_bytes = peak_.load(std::memory_order_relaxed);
+        s.alloc_count = allocs_.load(std::memory_order_relaxed);
+        s.free_count = frees_.load(std::memory_order_relaxed);
+        for (int i = 0; i < __ALLOC_HISTOGRAM_BUCKETS; ++i)
+            s.histogram[i] = histogram_[i].load(std::memory_order_relaxed);
+        return s;
+    }
+
+    // 峰值回到目前的存活字节，计数与分布归零
+    void reset() {
+        peak_.store(live_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        allocs_.store(0, std::memory_order_relaxed);
+        frees_.store(0, std::memory_order_relaxed);
+        for (int i = 0; i < __ALLOC_HISTOGRAM_BUCKETS; ++i)
+            histogram_[i].store(0, std::memory_order_relaxed);
+    }
+
+    const __alloc_stats* next() const { return next_; }
+    __alloc_stats* next() { return next_; }
+
+    static std::atomic<__alloc_stats*>& head() {
+        static std::atomic<__alloc_stats*> h(0);
+        return h;
+    }
+
+private:
+    static int bucket(size_t n) {
+        int i = 0;
+        while (i < __ALLOC_HISTOGRAM_BUCKETS - 1 && ((size_t)1 << i) < n)
+            ++i;
+        return i;
+    }
+
+    const char *tag_;
+    std::atomic<size_t> live_;
+    std::atomic<size_t> peak_;
+    std::atomic<size_t> allocs_;
+    std::atomic<size_t> frees_;
+    std::atomic<size_t> histogram_[__ALLOC_HISTOGRAM_BUCKETS];
+    __alloc_stats *next_;
+};
+
+// 带统计的配置器，可作为容器的Alloc参数，也可套在有状态的配置器外面
+template <class Tag, class Alloc = __plain_alloc>
+class traced_alloc : public Alloc {
 public:
-    static T* allocate(size_t n) {
-        return 0 == n ? 0 : (T*) malloc(n * sizeof (T));
+    traced_alloc() : Alloc() {}
+    traced_alloc(const Alloc& a) : Alloc(a) {}
+
+    void* allocate(size_t n) {
+        void *result = Alloc::allocate(n);
+        stats().record_alloc(n);
+        return result;
+    }
+    void deallocate(void *p, size_t n) {
+        Alloc::deallocate(p, n);
+        stats().record_free(n);
+    }
+    void* allocate_at_least(size_t &n, size_t unit = 1) {
+        void *result = __allocate_at_least((Alloc&)*this, n, unit, 0);
+        stats().record_alloc(n);
+        return result;
     }
-    static T* allocate(void) {
-        return (T*) malloc(sizeof (T));
+    // 计为一次释放加一次配置，以便看出vector反复扩充的情况
+    void* reallocate(void *p, size_t old_sz, size_t new_sz) {
+        void *result = __reallocate((Alloc&)*this, p, old_sz, new_sz, 0);
+        stats().record_free(old_sz);
+        stats().record_alloc(new_sz);
+        return result;
     }
-    static void deallocate(T* p, size_t n) {
+
+    static alloc_stats_snapshot snapshot() { return stats().snapshot(); }
+    static void reset() { stats().reset(); }
+
+    static __alloc_stats& stats() {
+        static __alloc_stats s(Tag::name());
+        return s;
+    }
+};
+
+template <class Tag, class Alloc>
+inline bool __deallocate_is_noop(const traced_alloc<Tag, Alloc>& a) {
+    return __deallocate_is_noop((const Alloc&)a);
+}
+
+// 把目前所有Tag的快照写入out，最多max_count个，返回Tag总数
+inline size_t alloc_stats_snapshot_all(alloc_stats_snapshot *out, size_t max_count) {
+    size_t n = 0;
+    for (const __alloc_stats *p = __alloc_stats::head().load(std::memory_order_acquire);
+         p != 0; p = p->next(), ++n)
+        if (n < max_count)
+            out[n] = p->snapshot();
+    return n;
+}
+
+// 以JSON格式输出所有Tag的统计，histogram的第i项对应(2^(i-1), 2^i]字节，
+// 末尾为0的项省略
+inline void dump_alloc_stats_json(FILE *out = stderr) {
+    fprintf(out, "[");
+    const char *sep = "";
+    for (const __alloc_stats *p = __alloc_stats::head().load(std::memory_order_acquire);
+         p != 0; p = p->next()) {
+        alloc_stats_snapshot s = p->snapshot();
+        fprintf(out, "%s\n  {\"tag\": \"%s\", \"live_bytes\": %zu, \"peak_bytes\": %zu, "
+                "\"alloc_count\": %zu, \"free_count\": %zu, \"histogram\": [",
+                sep, s.tag, s.live_bytes, s.peak_bytes, s.alloc_count, s.free_count);
+        int last = __ALLOC_HISTOGRAM_BUCKETS;
+        while (last > 0 && s.histogram[last - 1] == 0)
+            --last;
+        for (int i = 0; i < last; ++i)
+            fprintf(out, "%s%zu", i ? ", " : "", s.histogram[i]);
+        fprintf(out, "]}");
+        sep = ",";
+    }
+    fprintf(out, "\n]\n");
+}
+
+struct __default_alloc_tag {
+    static const char* name() { return "alloc"; }
+};
+
+// 令alloc为所有容器默认使用的配置器
+// 定义__TINY_ALLOC_TRACE后，默认配置器也计入统计，Tag为"alloc"
+#ifdef __TINY_ALLOC_TRACE
+typedef traced_alloc<__default_alloc_tag> alloc;
+#else
+typedef __plain_alloc alloc;
+#endif
+
+// 简单的转换接口，使配置器的配置单位从bytes转为元素的大小(sizeof(T))
+// Alloc以bytes为单位，须提供allocate(size_t)与deallocate(void*, size_t)，
+// 两者可以是static成员(如alloc)，也可以是带状态的一般成员函数
+// simple_alloc继承Alloc，容器再继承simple_alloc，借空基类优化(EBO)
+// 无状态的Alloc不占容器任何空间，有状态的Alloc则随容器保存一份
+template<class T, class Alloc = alloc>
+class simple_alloc : public Alloc {
+
+public:
+    typedef Alloc allocator_type;
+
+    simple_alloc() : Alloc() {}
+    simple_alloc(const Alloc& a) : Alloc(a) {}
+
+    allocator_type get_allocator() const { return *this; }
+
+    T* allocate(size_t n) {
+        return 0 == n ? 0 : (T*) Alloc::allocate(n * sizeof (T));
+    }
+    T* allocate(void) {
+        return (T*) Alloc::allocate(sizeof (T));
+    }
+    // 配置至少n个元素的空间，n改为实际可容纳的元素个数
+    // 以deallocate(p, n)释放时须传回改过的n
+    T* allocate_at_least(size_t &n) {
+        if (0 == n)
+            return 0;
+        size_t bytes = n * sizeof (T);
+        T* result = (T*) __allocate_at_least((Alloc&)*this, bytes, sizeof (T), 0);
+        n = bytes / sizeof (T);
+        return result;
+    }
+    // 把p所指的old_n个元素的区块改为new_n个，p不可以是0
+    // 内容以bytes搬移，只适用于可逐位复制的元素；超大区块可由mremap()原地扩充
+    T* reallocate(T* p, size_t old_n, size_t new_n) {
+        return (T*) __reallocate((Alloc&)*this, p, old_n * sizeof (T), new_n * sizeof (T), 0);
+    }
+    void deallocate(T* p, size_t n) {
         if(n != 0)
-            free(p);
+            Alloc::deallocate(p, n * sizeof (T));
+    }
+    void deallocate(T* p) {
+        Alloc::deallocate(p, sizeof (T));
     }
-    static void deallocate(T* p) {
-        free(p);
+    bool deallocate_is_noop() const {
+        return __deallocate_is_noop((const Alloc&)*this);
     }
 };
 
-#endif
\ No newline at end of file
+#endif
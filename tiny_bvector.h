@@ -0,0 +1,615 @@
+#ifndef __TINY_BVECTOR_H
+#define __TINY_BVECTOR_H
+
+// vector<bool>的特化版本：每个元素只占1个bit，以64位的word为存储单位
+// 元素不是真正的对象，operator[]与迭代器取值得到的是代理__bit_reference
+// fill、copy、equal、count另有针对bit迭代器的重载版本，一次处理一整个word；
+// find_first/find_next以计算尾端0的个数的指令直接跳到下一个为1的bit
+// 由tiny_vector.h在文件末尾引入，使用者不必直接包含本文件
+
+#include <cstring>
+#include <iterator>
+#include <algorithm>
+#include "tiny_alloc.h"
+#include "tiny_vector.h"
+
+typedef unsigned long long __bit_word;
+static const int __WORD_BIT = int(8 * sizeof(__bit_word));
+
+// word中为1的bit个数，以及最低位的1之下有几个0(w不可为0)
+inline int __bit_popcount(__bit_word w) {
+#if defined(__GNUC__)
+    return __builtin_popcountll(w);
+#else
+    int n = 0;
+    for ( ; w; w &= w - 1)
+        ++n;
+    return n;
+#endif
+}
+
+inline int __bit_ctz(__bit_word w) {
+#if defined(__GNUC__)
+    return __builtin_ctzll(w);
+#else
+    int n = 0;
+    for ( ; !(w & 1); w >>= 1)
+        ++n;
+    return n;
+#endif
+}
+
+// 代理引用：指出某个word中的某一个bit
+struct __bit_reference {
+    __bit_word* p;
+    __bit_word mask;
+    __bit_reference(__bit_word* x, __bit_word y) : p(x), mask(y) {}
+
+public:
+    __bit_reference() : p(0), mask(0) {}
+    operator bool() const { return !(!(*p & mask)); }
+    __bit_reference& operator=(bool x) {
+        if (x)
+            *p |= mask;
+        else
+            *p &= ~mask;
+        return *this;
+    }
+    __bit_reference& operator=(const __bit_reference& x) { return *this = bool(x); }
+    bool operator==(const __bit_reference& x) const { return bool(*this) == bool(x); }
+    bool operator<(const __bit_reference& x) const { return !bool(*this) && bool(x); }
+    void flip() { *p ^= mask; }
+};
+
+inline void swap(__bit_reference x, __bit_reference y) {
+    bool tmp = x;
+    x = y;
+    y = tmp;
+}
+
+// bit迭代器的共同部分：所在的word与word中的位置
+struct __bit_iterator_base {
+    typedef random_access_iterator_tag iterator_category;
+    typedef bool value_type;
+    typedef ptrdiff_t difference_type;
+
+    __bit_word* p;
+    unsigned int offset;
+
+    __bit_iterator_base(__bit_word* x, unsigned int y) : p(x), offset(y) {}
+
+    void bump_up() {
+        if (offset++ == __WORD_BIT - 1) {
+            offset = 0;
+            ++p;
+        }
+    }
+    void bump_down() {
+        if (offset-- == 0) {
+            offset = __WORD_BIT - 1;
+            --p;
+        }
+    }
+    void incr(ptrdiff_t i) {
+        ptrdiff_t n = i + offset;
+        p += n / __WORD_BIT;
+        n = n % __WORD_BIT;
+        if (n < 0) {
+            n += __WORD_BIT;
+            --p;
+        }
+        offset = (unsigned int)n;
+    }
+
+    bool operator==(const __bit_iterator_base& i) const { return p == i.p && offset == i.offset; }
+    bool operator<(const __bit_iterator_base& i) const {
+        return p < i.p || (p == i.p && offset < i.offset);
+    }
+    bool operator!=(const __bit_iterator_base& i) const { return !(*this == i); }
+    bool operator>(const __bit_iterator_base& i) const { return i < *this; }
+    bool operator<=(const __bit_iterator_base& i) const { return !(i < *this); }
+    bool operator>=(const __bit_iterator_base& i) const { return !(*this < i); }
+};
+
+inline ptrdiff_t operator-(const __bit_iterator_base& x, const __bit_iterator_base& y) {
+    return __WORD_BIT * (x.p - y.p) + (ptrdiff_t)x.offset - (ptrdiff_t)y.offset;
+}
+
+struct __bit_iterator : public __bit_iterator_base {
+    typedef __bit_reference reference;
+    typedef __bit_reference* pointer;
+    typedef __bit_iterator iterator;
+
+    __bit_iterator() : __bit_iterator_base(0, 0) {}
+    __bit_iterator(__bit_word* x, unsigned int y) : __bit_iterator_base(x, y) {}
+
+    reference operator*() const { return reference(p, __bit_word(1) << offset); }
+    iterator& operator++() {
+        bump_up();
+        return *this;
+    }
+    iterator operator++(int) {
+        iterator tmp = *this;
+        bump_up();
+        return tmp;
+    }
+    iterator& operator--() {
+        bump_down();
+        return *this;
+    }
+    iterator operator--(int) {
+        iterator tmp = *this;
+        bump_down();
+        return tmp;
+    }
+    iterator& operator+=(difference_type i) {
+        incr(i);
+        return *this;
+    }
+    iterator& operator-=(difference_type i) {
+        incr(-i);
+        return *this;
+    }
+    iterator operator+(difference_type i) const {
+        iterator tmp = *this;
+        return tmp += i;
+    }
+    iterator operator-(difference_type i) const {
+        iterator tmp = *this;
+        return tmp -= i;
+    }
+    reference operator[](difference_type i) const { return *(*this + i); }
+};
+
+inline __bit_iterator operator+(ptrdiff_t n, const __bit_iterator& x) { return x + n; }
+
+struct __bit_const_iterator : public __bit_iterator_base {
+    typedef bool reference;
+    typedef bool const_reference;
+    typedef const bool* pointer;
+    typedef __bit_const_iterator const_iterator;
+
+    __bit_const_iterator() : __bit_iterator_base(0, 0) {}
+    __bit_const_iterator(__bit_word* x, unsigned int y) : __bit_iterator_base(x, y) {}
+    __bit_const_iterator(const __bit_iterator& x) : __bit_iterator_base(x.p, x.offset) {}
+
+    const_reference operator*() const { return __bit_reference(p, __bit_word(1) << offset); }
+    const_iterator& operator++() {
+        bump_up();
+        return *this;
+    }
+    const_iterator operator++(int) {
+        const_iterator tmp = *this;
+        bump_up();
+        return tmp;
+    }
+    const_iterator& operator--() {
+        bump_down();
+        return *this;
+    }
+    const_iterator operator--(int) {
+        const_iterator tmp = *this;
+        bump_down();
+        return tmp;
+    }
+    const_iterator& operator+=(difference_type i) {
+        incr(i);
+        return *this;
+    }
+    const_iterator& operator-=(difference_type i) {
+        incr(-i);
+        return *this;
+    }
+    const_iterator operator+(difference_type i) const {
+        const_iterator tmp = *this;
+        return tmp += i;
+    }
+    const_iterator operator-(difference_type i) const {
+        const_iterator tmp = *this;
+        return tmp -= i;
+    }
+    const_reference operator[](difference_type i) const { return *(*this + i); }
+};
+
+inline __bit_const_iterator operator+(ptrdiff_t n, const __bit_const_iterator& x) { return x + n; }
+
+// 以下是以word为单位的算法
+// 头尾不满一个word的部分逐bit处理，中间整个word一次处理
+
+// 从first起取出连续64个bit，first不在word边界上时由相邻两个word拼成
+inline __bit_word __bit_read_word(const __bit_iterator_base& first) {
+    if (first.offset == 0)
+        return *first.p;
+    return (first.p[0] >> first.offset) | (first.p[1] << (__WORD_BIT - first.offset));
+}
+
+inline __bit_iterator __bit_copy(__bit_iterator_base first, __bit_iterator_base last,
+                                 __bit_iterator result) {
+    ptrdiff_t n = last - first;
+    __bit_const_iterator src(first.p, first.offset);
+    // 先逐bit复制，直到目的端对齐到word边界
+    for ( ; n > 0 && result.offset != 0; --n, ++src, ++result)
+        *result = *src;
+    // 目的端每次写入一整个word，由前往后，目的端在来源之前的重叠区间也正确
+    for ( ; n >= __WORD_BIT; n -= __WORD_BIT) {
+        *result.p++ = __bit_read_word(src);
+        src.p++;
+    }
+    for ( ; n > 0; --n, ++src, ++result)
+        *result = *src;
+    return result;
+}
+
+inline __bit_iterator copy(__bit_iterator first, __bit_iterator last, __bit_iterator result) {
+    return __bit_copy(first, last, result);
+}
+inline __bit_iterator copy(__bit_const_iterator first, __bit_const_iterator last,
+                           __bit_iterator result) {
+    return __bit_copy(first, last, result);
+}
+
+// 把[first,last)的每个bit设为x
+inline void __bit_fill(__bit_iterator first, __bit_iterator last, bool x) {
+    ptrdiff_t n = last - first;
+    for ( ; n > 0 && first.offset != 0; --n, ++first)
+        *first = x;
+    const __bit_word w = x ? ~__bit_word(0) : __bit_word(0);
+    for ( ; n >= __WORD_BIT; n -= __WORD_BIT)
+        *first.p++ = w;
+    for ( ; n > 0; --n, ++first)
+        *first = x;
+}
+
+inline void fill(__bit_iterator first, __bit_iterator last, const bool& x) {
+    __bit_fill(first, last, x);
+}
+inline __bit_iterator fill_n(__bit_iterator first, size_t n, const bool& x) {
+    __bit_fill(first, first + n, x);
+    return first + n;
+}
+
+inline bool __bit_equal(__bit_iterator_base first1, __bit_iterator_base last1,
+                        __bit_iterator_base first2) {
+    ptrdiff_t n = last1 - first1;
+    __bit_const_iterator i(first1.p, first1.offset), j(first2.p, first2.offset);
+    for ( ; n > 0 && i.offset != 0; --n, ++i, ++j)
+        if (*i != *j)
+            return false;
+    for ( ; n >= __WORD_BIT; n -= __WORD_BIT, ++i.p, ++j.p)
+        if (*i.p != __bit_read_word(j))
+            return false;
+    for ( ; n > 0; --n, ++i, ++j)
+        if (*i != *j)
+            return false;
+    return true;
+}
+
+inline bool equal(__bit_iterator first1, __bit_iterator last1, __bit_iterator first2) {
+    return __bit_equal(first1, last1, first2);
+}
+inline bool equal(__bit_const_iterator first1, __bit_const_iterator last1,
+                  __bit_const_iterator first2) {
+    return __bit_equal(first1, last1, first2);
+}
+
+// [first,last)中值为x的bit个数，整个word以popcount计算
+inline ptrdiff_t __bit_count(__bit_iterator_base first, __bit_iterator_base last, bool x) {
+    ptrdiff_t n = last - first;
+    ptrdiff_t ones = 0;
+    __bit_const_iterator i(first.p, first.offset);
+    for ( ; n > 0 && i.offset != 0; --n, ++i)
+        ones += *i;
+    for ( ; n >= __WORD_BIT; n -= __WORD_BIT)
+        ones += __bit_popcount(*i.p++);
+    for ( ; n > 0; --n, ++i)
+        ones += *i;
+    return x ? ones : (last - first) - ones;
+}
+
+inline ptrdiff_t count(__bit_iterator first, __bit_iterator last, const bool& x) {
+    return __bit_count(first, last, x);
+}
+inline ptrdiff_t count(__bit_const_iterator first, __bit_const_iterator last, const bool& x) {
+    return __bit_count(first, last, x);
+}
+
+template <class Alloc, class Growth>
+class vector<bool, Alloc, Growth> : protected simple_alloc<__bit_word, Alloc> {
+    public:
+        typedef bool value_type;
+        typedef size_t size_type;
+        typedef ptrdiff_t difference_type;
+        typedef __bit_reference reference;
+        typedef bool const_reference;
+        typedef __bit_reference* pointer;
+        typedef const bool* const_pointer;
+        typedef __bit_iterator iterator;
+        typedef __bit_const_iterator const_iterator;
+        typedef Alloc allocator_type;
+        typedef Growth growth_policy;
+
+        typedef reverse_iterator<const_iterator> const_reverse_iterator;
+        typedef reverse_iterator<iterator> reverse_iterator;
+
+    protected:
+        typedef simple_alloc<__bit_word, Alloc> data_allocator;
+        iterator start;
+        iterator finish;
+        __bit_word* end_of_storage;
+
+        // 容纳n个bit需要的word个数
+        static size_type words_for(size_type n) { return (n + __WORD_BIT - 1) / __WORD_BIT; }
+        // 配置至少n个bit的空间，n改为实际配置的word个数
+        __bit_word* bit_alloc(size_type& n) {
+            n = words_for(n);
+            return data_allocator::allocate_at_least(n);
+        }
+        void deallocate() {
+            if (start.p)
+                data_allocator::deallocate(start.p, end_of_storage - start.p);
+        }
+        void initialize(size_type n) {
+            size_type words = n;
+            __bit_word* q = bit_alloc(words);
+            end_of_storage = q + words;
+            start = iterator(q, 0);
+            finish = start + difference_type(n);
+        }
+        // 空间不足时重新配置，使之至少能再容纳n个bit，由增长策略决定新长度
+        void grow(size_type n) {
+            const size_type old_words = end_of_storage - start.p;
+            const size_type need = words_for(size() + n) - old_words;
+            size_type len = Growth::grow(old_words, need, sizeof(__bit_word));
+            __bit_word* q = data_allocator::allocate_at_least(len);
+            iterator new_finish = copy(begin(), end(), iterator(q, 0));
+            deallocate();
+            start = iterator(q, 0);
+            finish = new_finish;
+            end_of_storage = q + len;
+        }
+        void insert_aux(iterator position, bool x) {
+            if (finish.p != end_of_storage) {
+                copy_backward(position, finish, finish + 1);
+                *position = x;
+                ++finish;
+            }
+            else {
+                const difference_type off = position - begin();
+                grow(1);
+                position = begin() + off;
+                copy_backward(position, finish, finish + 1);
+                *position = x;
+                ++finish;
+            }
+        }
+        template <class Integer>
+        void initialize_dispatch(Integer n, Integer x, true_type) {
+            initialize(n);
+            fill(start.p, end_of_storage, x ? ~__bit_word(0) : __bit_word(0));
+        }
+        template <class InputIterator>
+        void initialize_dispatch(InputIterator first, InputIterator last, false_type) {
+            range_initialize(first, last, typename iterator_traits<InputIterator>::iterator_category());
+        }
+        template <class InputIterator>
+        void range_initialize(InputIterator first, InputIterator last, input_iterator_tag) {
+            try {
+                for ( ; first != last; ++first)
+                    push_back(*first);
+            }
+            catch(...) {
+                deallocate();
+                throw;
+            }
+        }
+        template <class ForwardIterator>
+        void range_initialize(ForwardIterator first, ForwardIterator last, forward_iterator_tag) {
+            initialize(distance(first, last));
+            copy(first, last, start);
+        }
+        template <class Integer>
+        void insert_dispatch(iterator position, Integer n, Integer x, true_type) {
+            insert(position, (size_type)n, (bool)x);
+        }
+        template <class InputIterator>
+        void insert_dispatch(iterator position, InputIterator first, InputIterator last, false_type) {
+            vector<bool, Alloc, Growth> tmp(first, last, get_allocator());
+            const difference_type off = position - begin();
+            const size_type n = tmp.size();
+            if (size_type(capacity() - size()) < n)
+                grow(n);
+            position = begin() + off;
+            copy_backward(position, finish, finish + difference_type(n));
+            copy(tmp.begin(), tmp.end(), position);
+            finish += difference_type(n);
+        }
+
+    public:
+        allocator_type get_allocator() const { return data_allocator::get_allocator(); }
+
+        iterator begin() { return start; }
+        const_iterator begin() const { return start; }
+        iterator end() { return finish; }
+        const_iterator end() const { return finish; }
+
+        reverse_iterator rbegin() { return reverse_iterator(end()); }
+        const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+        reverse_iterator rend() { return reverse_iterator(begin()); }
+        const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+        size_type size() const { return size_type(end() - begin()); }
+        size_type max_size() const { return size_type(-1); }
+        size_type capacity() const {
+            return size_type(const_iterator(end_of_storage, 0) - begin());
+        }
+        bool empty() const { return begin() == end(); }
+
+        reference operator[](size_type n) { return *(begin() + difference_type(n)); }
+        const_reference operator[](size_type n) const { return *(begin() + difference_type(n)); }
+        reference at(size_type n) { return (*this)[n]; }
+        const_reference at(size_type n) const { return (*this)[n]; }
+
+        reference front() { return *begin(); }
+        const_reference front() const { return *begin(); }
+        reference back() { return *(end() - 1); }
+        const_reference back() const { return *(end() - 1); }
+
+    public:
+        vector() : start(0, 0), finish(0, 0), end_of_storage(0) {}
+        explicit vector(const allocator_type& a)
+            : data_allocator(a), start(0, 0), finish(0, 0), end_of_storage(0) {}
+        vector(size_type n, bool value, const allocator_type& a = allocator_type())
+            : data_allocator(a) {
+            initialize(n);
+            fill(start.p, end_of_storage, value ? ~__bit_word(0) : __bit_word(0));
+        }
+        explicit vector(size_type n) {
+            initialize(n);
+            fill(start.p, end_of_storage, __bit_word(0));
+        }
+        template <class InputIterator>
+        vector(InputIterator first, InputIterator last, const allocator_type& a = allocator_type())
+            : data_allocator(a), start(0, 0), finish(0, 0), end_of_storage(0) {
+            initialize_dispatch(first, last, is_integral<InputIterator>());
+        }
+        vector(const vector<bool, Alloc, Growth>& x) : data_allocator(x) {
+            initialize(x.size());
+            copy(x.begin(), x.end(), start);
+        }
+        vector(vector<bool, Alloc, Growth>&& x) noexcept
+            : data_allocator(x), start(x.start), finish(x.finish), end_of_storage(x.end_of_storage) {
+            x.start = x.finish = iterator(0, 0);
+            x.end_of_storage = 0;
+        }
+        ~vector() { deallocate(); }
+
+        vector<bool, Alloc, Growth>& operator=(const vector<bool, Alloc, Growth>& x) {
+            if (&x != this) {
+                if (x.size() > capacity()) {
+                    deallocate();
+                    initialize(x.size());
+                }
+                copy(x.begin(), x.end(), begin());
+                finish = begin() + difference_type(x.size());
+            }
+            return *this;
+        }
+        vector<bool, Alloc, Growth>& operator=(vector<bool, Alloc, Growth>&& x) noexcept {
+            if (&x != this) {
+                deallocate();
+                (data_allocator&)*this = (data_allocator&)x;
+                start = x.start;
+                finish = x.finish;
+                end_of_storage = x.end_of_storage;
+                x.start = x.finish = iterator(0, 0);
+                x.end_of_storage = 0;
+            }
+            return *this;
+        }
+
+        void reserve(size_type n) {
+            if (capacity() < n) {
+                size_type len = n;
+                __bit_word* q = bit_alloc(len);
+                finish = copy(begin(), end(), iterator(q, 0));
+                deallocate();
+                start = iterator(q, 0);
+                end_of_storage = q + len;
+            }
+        }
+
+        void push_back(bool x) {
+            if (finish.p != end_of_storage)
+                *finish++ = x;
+            else
+                insert_aux(end(), x);
+        }
+        void pop_back() { --finish; }
+
+        void swap(vector<bool, Alloc, Growth>& x) {
+            std::swap((data_allocator&)*this, (data_allocator&)x);
+            std::swap(start, x.start);
+            std::swap(finish, x.finish);
+            std::swap(end_of_storage, x.end_of_storage);
+        }
+        static void swap(reference x, reference y) { ::swap(x, y); }
+
+        iterator insert(iterator position, bool x = bool()) {
+            const difference_type n = position - begin();
+            if (finish.p != end_of_storage && position == end())
+                *finish++ = x;
+            else
+                insert_aux(position, x);
+            return begin() + n;
+        }
+        void insert(iterator position, size_type n, bool x) {
+            if (n == 0)
+                return;
+            const difference_type off = position - begin();
+            if (capacity() - size() < n)
+                grow(n);
+            position = begin() + off;
+            copy_backward(position, finish, finish + difference_type(n));
+            fill(position, position + difference_type(n), x);
+            finish += difference_type(n);
+        }
+        template <class InputIterator>
+        void insert(iterator position, InputIterator first, InputIterator last) {
+            insert_dispatch(position, first, last, is_integral<InputIterator>());
+        }
+
+        iterator erase(iterator position) {
+            if (position + 1 != end())
+                copy(position + 1, end(), position);
+            --finish;
+            return position;
+        }
+        iterator erase(iterator first, iterator last) {
+            finish = copy(last, end(), first);
+            return first;
+        }
+        void resize(size_type new_size, bool x = bool()) {
+            if (new_size < size())
+                erase(begin() + difference_type(new_size), end());
+            else
+                insert(end(), new_size - size(), x);
+        }
+        void assign(size_type n, bool x) {
+            clear();
+            insert(end(), n, x);
+        }
+        void clear() { erase(begin(), end()); }
+
+        // 把每个bit反相
+        void flip() {
+            for (__bit_word* w = start.p; w != end_of_storage; ++w)
+                *w = ~*w;
+        }
+
+        // 第一个值为1的bit的位置，没有时传回size()
+        size_type find_first() const { return find_from(0); }
+        // prev之后第一个值为1的bit的位置，没有时传回size()
+        size_type find_next(size_type prev) const { return find_from(prev + 1); }
+
+    protected:
+        // 从第pos个bit起找第一个1：先屏蔽起点word中pos之前的bit，之后逐word跳过全0的word
+        size_type find_from(size_type pos) const {
+            const size_type n = size();
+            if (pos >= n)
+                return n;
+            const __bit_word* w = start.p + pos / __WORD_BIT;
+            const __bit_word* last = start.p + words_for(n);
+            __bit_word cur = *w & (~__bit_word(0) << (pos % __WORD_BIT));
+            while (cur == 0) {
+                if (++w == last)
+                    return n;
+                cur = *w;
+            }
+            size_type result = (w - start.p) * __WORD_BIT + __bit_ctz(cur);
+            return result < n ? result : n;
+        }
+};
+
+typedef vector<bool, alloc> bit_vector;
+
+#endif
@@ -0,0 +1,251 @@
+#ifndef __TINY_CONCURRENT_VECTOR_H
+#define __TINY_CONCURRENT_VECTOR_H
+
+#include <atomic>
+#include <iterator>
+#include "tiny_alloc.h"
+#include "tiny_construct.h"
+
+// concurrent_vector<T>：可由多个线程同时push_back/grow_by的分段vector
+//
+// 元素分存在一组大小为2的幂的段(segment)中：第0段有2^first_shift个元素，
+// 之后第k段的大小等于前面各段的总和，因此k段合计恰为2^(first_shift+k)个元素
+// 段表类似deque的map，但大小固定，不必重新配置；已有的段永不搬移，
+// 元素的地址在容器析构(或clear)之前始终有效，读者可放心持有指针或引用
+// 第i个元素所在的段由i的最高位直接算出，operator[]是O(1)
+//
+// push_back与grow_by以原子的fetch_add预留位置，互不阻塞；所需的段尚未配置时，
+// 各线程各自配置，以compare_exchange决定谁的生效，其余的归还
+// size()是已预留的元素个数，其中可能有元素正由其他线程构造中：
+// 读者须经由其他同步手段(例如由写者传递下标)得知某元素已构造完成
+// 元素的构造函数不可抛出异常，否则已预留的位置无法回收
+// reserve()可与push_back并行；clear()、swap()、析构与赋值都不可与其他操作并行
+template <class T, class Alloc = alloc>
+class concurrent_vector : protected simple_alloc<T, Alloc> {
+    public:
+        typedef T value_type;
+        typedef value_type* pointer;
+        typedef const value_type* const_pointer;
+        typedef value_type& reference;
+        typedef const value_type& const_reference;
+        typedef size_t size_type;
+        typedef ptrdiff_t difference_type;
+        typedef Alloc allocator_type;
+
+    protected:
+        typedef simple_alloc<value_type, Alloc> data_allocator;
+        enum { first_shift = 3 };       // 第0段有8个元素
+        enum { max_segments = 8 * sizeof(size_type) - first_shift + 1 };
+
+        atomic<T*> segments[max_segments];     // 段表，未配置的段为0
+        atomic<size_type> reserved;            // 已预留的元素个数
+
+        static int log2_floor(size_type n) {
+#if defined(__GNUC__)
+            return int(8 * sizeof(unsigned long long)) - 1 - __builtin_clzll((unsigned long long)n);
+#else
+            int k = -1;
+            for ( ; n; n >>= 1)
+                ++k;
+            return k;
+#endif
+        }
+        // 第i个元素所在的段，以及该段第一个元素的下标与段的大小
+        static size_type segment_index(size_type i) {
+            return log2_floor(i | ((size_type(1) << first_shift) - 1)) - first_shift + 1;
+        }
+        static size_type segment_base(size_type k) {
+            return k == 0 ? 0 : size_type(1) << (k + first_shift - 1);
+        }
+        static size_type segment_size(size_type k) {
+            return k == 0 ? size_type(1) << first_shift : segment_base(k);
+        }
+
+        // 确保第k段已配置，多个线程同时配置时只保留一个
+        T* segment(size_type k) {
+            T* seg = segments[k].load(memory_order_acquire);
+            if (seg == 0) {
+                T* fresh = data_allocator::allocate(segment_size(k));
+                if (segments[k].compare_exchange_strong(seg, fresh, memory_order_acq_rel))
+                    seg = fresh;
+                else
+                    data_allocator::deallocate(fresh, segment_size(k));
+            }
+            return seg;
+        }
+        // 在[first, first+n)的每个位置构造x，这些位置可能跨越多个段
+        void construct_range(size_type first, size_type n, const T& x) {
+            while (n > 0) {
+                const size_type k = segment_index(first);
+                const size_type off = first - segment_base(k);
+                size_type len = segment_size(k) - off;
+                if (len > n)
+                    len = n;
+                Uninitialized_fill_n(segment(k) + off, len, x);
+                first += len;
+                n -= len;
+            }
+        }
+        // 析构前n个元素并归还所有的段
+        void destroy_and_deallocate(size_type n) {
+            for (size_type k = 0; k < size_type(max_segments); ++k) {
+                T* seg = segments[k].load(memory_order_relaxed);
+                if (seg == 0)
+                    break;
+                const size_type base = segment_base(k);
+                if (base < n) {
+                    const size_type len = n - base < segment_size(k) ? n - base : segment_size(k);
+                    Destroy(seg, seg + len);
+                }
+                data_allocator::deallocate(seg, segment_size(k));
+                segments[k].store(0, memory_order_relaxed);
+            }
+        }
+        void empty_initialize() {
+            for (size_type k = 0; k < size_type(max_segments); ++k)
+                segments[k].store(0, memory_order_relaxed);
+            reserved.store(0, memory_order_relaxed);
+        }
+
+    public:
+        // 以下标走访的随机存取迭代器，push_back不会使之失效
+        template <class Container, class Ref, class Ptr>
+        struct __iterator {
+            typedef random_access_iterator_tag iterator_category;
+            typedef T value_type;
+            typedef Ref reference;
+            typedef Ptr pointer;
+            typedef ptrdiff_t difference_type;
+            typedef __iterator self;
+
+            Container* v;
+            size_type index;
+
+            __iterator() : v(0), index(0) {}
+            __iterator(Container* c, size_type i) : v(c), index(i) {}
+            template <class C, class R, class P>
+            __iterator(const __iterator<C, R, P>& x) : v(x.v), index(x.index) {}
+
+            reference operator*() const { return (*v)[index]; }
+            pointer operator->() const { return &(*v)[index]; }
+            reference operator[](difference_type n) const { return (*v)[index + n]; }
+
+            self& operator++() { ++index; return *this; }
+            self operator++(int) { self tmp = *this; ++index; return tmp; }
+            self& operator--() { --index; return *this; }
+            self operator--(int) { self tmp = *this; --index; return tmp; }
+            self& operator+=(difference_type n) { index += n; return *this; }
+            self& operator-=(difference_type n) { index -= n; return *this; }
+            self operator+(difference_type n) const { return self(v, index + n); }
+            self operator-(difference_type n) const { return self(v, index - n); }
+            difference_type operator-(const self& x) const { return difference_type(index - x.index); }
+
+            bool operator==(const self& x) const { return index == x.index; }
+            bool operator!=(const self& x) const { return index != x.index; }
+            bool operator<(const self& x) const { return index < x.index; }
+            bool operator>(const self& x) const { return x.index < index; }
+            bool operator<=(const self& x) const { return index <= x.index; }
+            bool operator>=(const self& x) const { return index >= x.index; }
+        };
+        typedef __iterator<concurrent_vector, T&, T*> iterator;
+        typedef __iterator<const concurrent_vector, const T&, const T*> const_iterator;
+
+    public:
+        concurrent_vector() { empty_initialize(); }
+        explicit concurrent_vector(const allocator_type& a) : data_allocator(a) { empty_initialize(); }
+        explicit concurrent_vector(size_type n, const T& x = T()) {
+            empty_initialize();
+            grow_by(n, x);
+        }
+        concurrent_vector(const concurrent_vector& x) : data_allocator(x) {
+            empty_initialize();
+            reserve(x.size());
+            for (size_type i = 0; i < x.size(); ++i)
+                push_back(x[i]);
+        }
+        ~concurrent_vector() { destroy_and_deallocate(size()); }
+
+        concurrent_vector& operator=(const concurrent_vector& x) {
+            if (this != &x) {
+                clear();
+                reserve(x.size());
+                for (size_type i = 0; i < x.size(); ++i)
+                    push_back(x[i]);
+            }
+            return *this;
+        }
+
+        allocator_type get_allocator() const { return data_allocator::get_allocator(); }
+
+        iterator begin() { return iterator(this, 0); }
+        const_iterator begin() const { return const_iterator(this, 0); }
+        iterator end() { return iterator(this, size()); }
+        const_iterator end() const { return const_iterator(this, size()); }
+
+        size_type size() const { return reserved.load(memory_order_acquire); }
+        bool empty() const { return size() == 0; }
+        size_type max_size() const { return size_type(-1) / sizeof(T); }
+        // 从第0段起连续已配置的段可容纳的元素个数
+        size_type capacity() const {
+            size_type k = 0;
+            while (k < size_type(max_segments) && segments[k].load(memory_order_acquire) != 0)
+                ++k;
+            return segment_base(k);
+        }
+
+        reference operator[](size_type i) {
+            const size_type k = segment_index(i);
+            return segments[k].load(memory_order_acquire)[i - segment_base(k)];
+        }
+        const_reference operator[](size_type i) const {
+            const size_type k = segment_index(i);
+            return segments[k].load(memory_order_acquire)[i - segment_base(k)];
+        }
+        reference at(size_type i) { return (*this)[i]; }
+        const_reference at(size_type i) const { return (*this)[i]; }
+        reference front() { return (*this)[0]; }
+        const_reference front() const { return (*this)[0]; }
+        reference back() { return (*this)[size() - 1]; }
+        const_reference back() const { return (*this)[size() - 1]; }
+
+        // 预先配置足以容纳n个元素的段，可与push_back并行
+        void reserve(size_type n) {
+            if (n == 0)
+                return;
+            for (size_type k = 0; k <= segment_index(n - 1); ++k)
+                segment(k);
+        }
+
+        // 在尾端新增一个元素，传回其下标；多个线程可同时调用
+        size_type push_back(const T& x) {
+            const size_type i = reserved.fetch_add(1, memory_order_acq_rel);
+            const size_type k = segment_index(i);
+            Construct(segment(k) + (i - segment_base(k)), x);
+            return i;
+        }
+        // 在尾端新增n个x，传回第一个新元素的下标；多个线程可同时调用
+        size_type grow_by(size_type n, const T& x = T()) {
+            const size_type first = reserved.fetch_add(n, memory_order_acq_rel);
+            construct_range(first, n, x);
+            return first;
+        }
+
+        // 析构所有元素并归还所有的段
+        void clear() {
+            destroy_and_deallocate(size());
+            reserved.store(0, memory_order_release);
+        }
+        void swap(concurrent_vector& x) {
+            std::swap((data_allocator&)*this, (data_allocator&)x);
+            for (size_type k = 0; k < size_type(max_segments); ++k) {
+                T* tmp = segments[k].load(memory_order_relaxed);
+                segments[k].store(x.segments[k].load(memory_order_relaxed), memory_order_relaxed);
+                x.segments[k].store(tmp, memory_order_relaxed);
+            }
+            size_type tmp = reserved.load(memory_order_relaxed);
+            reserved.store(x.reserved.load(memory_order_relaxed), memory_order_relaxed);
+            x.reserved.store(tmp, memory_order_relaxed);
+        }
+};
+
+#endif
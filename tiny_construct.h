@@ -1,36 +1,256 @@
 #ifndef __TINY_CONSTRUCT_H
 #define __TINY_CONSTRUCT_H
-using namespace std;
-#include <new.h>
 
-/*此模板尚未弄懂如何实现
-*为此调用STL提供的接口
-*/
+#include <new>
+#include <cstring>
+#include <iterator>
+#include <utility>
+#include "tiny_type_traits.h"
+
+using namespace std;
 
 // 调用construct和destroy的全局函数
+// 依__type_traits决定能否略过析构，或以memset一次完成构造
 
-// 以下是Construct()的第一个版本
-template <class T1, class T2>
-inline void Construct(T1* p, const T2& value) {
-  _Construct(p,value);
+// 在p所指空间以args为参数构造对象，参数原样转发
+// Construct(p)构造一个值初始化的对象，Construct(p, value)以value为初值，
+// 传入右值时调用move constructor
+template <class T, class... Args>
+inline void Construct(T* p, Args&&... args) {
+    new ((void*)p) T(std::forward<Args>(args)...);   // placement new
 }
 
-// 以下是Construct()的第二个版本
+// 以下是Destroy()的第一个版本，接受一个指针
 template <class T>
-inline void Construct(T* p) {
-  _Construct(p);
+inline void Destroy(T* pointer) {
+    pointer->~T();      // 调用析构函数
 }
 
-// 以下是destroy()的第一个版本，接受一个指针
-template <class T>
-inline void Destroy(T* pointer) {
-  _Destroy(pointer);
+// 元素有non-trivial destructor：逐一调用析构函数
+template <class ForwardIterator>
+inline void __destroy_aux(ForwardIterator first, ForwardIterator last, false_type) {
+    for ( ; first != last; ++first)
+        Destroy(&*first);
 }
 
-// 以下是destory()第二版本，接受两个迭代器。
+// 元素有trivial destructor：什么也不做
+template <class ForwardIterator>
+inline void __destroy_aux(ForwardIterator, ForwardIterator, true_type) {}
+
+// 以下是Destroy()的第二版本，接受两个迭代器
+// 依元素型别的has_trivial_destructor决定是否需要走访区间
 template <class ForwardIterator>
 inline void Destroy(ForwardIterator first, ForwardIterator last) {
-  _Destroy(first, last);
+    typedef typename iterator_traits<ForwardIterator>::value_type value_type;
+    typedef typename __type_traits<value_type>::has_trivial_destructor trivial_destructor;
+    __destroy_aux(first, last, trivial_destructor());
+}
+
+// 以下是针对char*和wchar_t*的特化版本
+inline void Destroy(char*, char*) {}
+inline void Destroy(wchar_t*, wchar_t*) {}
+
+// 元素是算术、枚举或指针型别：值初始化即全部清零，连续空间可一次memset
+// (成员指针的空值并非全零，不在此列；POD结构的逐一构造通常也会被编译器合并为memset)
+template <class T, class Size>
+inline T* __construct_n_aux(T* first, Size n, true_type) {
+    memset((void*)first, 0, n * sizeof(T));
+    return first + n;
+}
+
+// 其他型别，或区间不连续：逐一构造，中途抛出异常时析构已构造的元素
+template <class ForwardIterator, class Size>
+ForwardIterator __construct_n_aux(ForwardIterator first, Size n, false_type) {
+    ForwardIterator cur = first;
+    try {
+        for ( ; n > 0; --n, ++cur)
+            Construct(&*cur);
+        return cur;
+    }
+    catch(...) {
+        Destroy(first, cur);
+        throw;
+    }
+}
+
+template <class ForwardIterator, class Size>
+inline ForwardIterator __construct_n_dispatch(ForwardIterator first, Size n, false_type) {
+    return __construct_n_aux(first, n, false_type());
+}
+
+template <class T, class Size>
+inline T* __construct_n_dispatch(T* first, Size n, true_type) {
+    return __construct_n_aux(first, n,
+        integral_constant<bool, is_scalar<T>::value && !is_member_pointer<T>::value>());
+}
+
+// 在[first, first+n)的未初始化空间上值初始化n个元素，返回构造区间的尾端
+template <class ForwardIterator, class Size>
+inline ForwardIterator Construct_n(ForwardIterator first, Size n) {
+    return __construct_n_dispatch(first, n,
+        integral_constant<bool, is_pointer<ForwardIterator>::value>());
+}
+
+// 以下是未初始化空间上的复制与填充
+// 依迭代器种类与元素型别的特性分派：连续空间且可逐位复制时以memmove/memset一次完成，
+// 否则逐一构造，中途抛出异常时析构已构造的元素(commit or rollback)
+// __deque_iterator的区间在tiny_deque.h中另有逐段处理的重载版本
+// (名称大写开头，以免与using namespace std引入的std::uninitialized_copy冲突)
+
+// 源与目的都是指针、元素型别相同且copy constructor为trivial时，可以memmove复制
+template <class InputIterator, class ForwardIterator>
+struct __memmove_copyable {
+    typedef typename remove_const<typename remove_pointer<InputIterator>::type>::type source_type;
+    typedef typename remove_pointer<ForwardIterator>::type value_type;
+    typedef integral_constant<bool,
+        is_pointer<InputIterator>::value && is_pointer<ForwardIterator>::value &&
+        is_same<source_type, value_type>::value &&
+        __type_traits<value_type>::has_trivial_copy_constructor::value> type;
+};
+
+template <class T>
+inline T* __uninitialized_copy_aux(const T* first, const T* last, T* result, true_type) {
+    size_t n = last - first;
+    if (n != 0)
+        memmove((void*)result, (const void*)first, n * sizeof(T));
+    return result + n;
+}
+
+template <class InputIterator, class ForwardIterator>
+ForwardIterator __uninitialized_copy_aux(InputIterator first, InputIterator last,
+                                         ForwardIterator result, false_type) {
+    ForwardIterator cur = result;
+    try {
+        for ( ; first != last; ++first, ++cur)
+            Construct(&*cur, *first);
+        return cur;
+    }
+    catch(...) {
+        Destroy(result, cur);
+        throw;
+    }
+}
+
+// 把[first,last)复制到以result起始的未初始化空间，返回复制区间的尾端
+template <class InputIterator, class ForwardIterator>
+inline ForwardIterator Uninitialized_copy(InputIterator first, InputIterator last,
+                                          ForwardIterator result) {
+    return __uninitialized_copy_aux(first, last, result,
+        typename __memmove_copyable<InputIterator, ForwardIterator>::type());
+}
+
+// x的每个byte是否相同，若是传回该byte值，可以memset填充
+template <class T>
+inline bool __is_byte_pattern(const T& x, unsigned char& byte) {
+    const unsigned char *p = (const unsigned char*)&x;
+    for (size_t i = 1; i < sizeof(T); ++i)
+        if (p[i] != p[0])
+            return false;
+    byte = p[0];
+    return true;
+}
+
+// 连续空间且可逐位复制：单字节元素或x的每个byte都相同(包括全零)时memset，
+// 否则逐一赋值，编译器可将这样的循环向量化
+template <class T, class Size>
+inline T* __uninitialized_fill_n_aux(T* first, Size n, const T& x, true_type) {
+    unsigned char byte;
+    if (n > 0 && __is_byte_pattern(x, byte))
+        memset((void*)first, byte, n * sizeof(T));
+    else
+        for (Size i = 0; i < n; ++i)
+            first[i] = x;
+    return first + (n > 0 ? n : 0);
+}
+
+template <class ForwardIterator, class Size, class T>
+ForwardIterator __uninitialized_fill_n_aux(ForwardIterator first, Size n, const T& x, false_type) {
+    ForwardIterator cur = first;
+    try {
+        for ( ; n > 0; --n, ++cur)
+            Construct(&*cur, x);
+        return cur;
+    }
+    catch(...) {
+        Destroy(first, cur);
+        throw;
+    }
+}
+
+// 源是单一的值x，目的为指针且元素可逐位复制时走memset/赋值的快速路径
+template <class ForwardIterator, class T>
+struct __memset_fillable {
+    typedef typename remove_pointer<ForwardIterator>::type value_type;
+    typedef integral_constant<bool,
+        is_pointer<ForwardIterator>::value && is_same<T, value_type>::value &&
+        __type_traits<value_type>::has_trivial_copy_constructor::value &&
+        __type_traits<value_type>::has_trivial_assignment_operator::value> type;
+};
+
+// 在以first起始的未初始化空间上构造n个x，返回构造区间的尾端
+template <class ForwardIterator, class Size, class T>
+inline ForwardIterator Uninitialized_fill_n(ForwardIterator first, Size n, const T& x) {
+    return __uninitialized_fill_n_aux(first, n, x,
+        typename __memset_fillable<ForwardIterator, T>::type());
+}
+
+template <class T>
+inline void __uninitialized_fill_aux(T* first, T* last, const T& x, true_type) {
+    __uninitialized_fill_n_aux(first, last - first, x, true_type());
+}
+
+template <class ForwardIterator, class T>
+void __uninitialized_fill_aux(ForwardIterator first, ForwardIterator last, const T& x, false_type) {
+    ForwardIterator cur = first;
+    try {
+        for ( ; cur != last; ++cur)
+            Construct(&*cur, x);
+    }
+    catch(...) {
+        Destroy(first, cur);
+        throw;
+    }
+}
+
+// 在[first,last)的未初始化空间上构造x的副本
+template <class ForwardIterator, class T>
+inline void Uninitialized_fill(ForwardIterator first, ForwardIterator last, const T& x) {
+    __uninitialized_fill_aux(first, last, x,
+        typename __memset_fillable<ForwardIterator, T>::type());
+}
+
+// 把[first,last)搬到以result起始的未初始化空间，供容器重新配置时使用
+// 元素的move constructor不会抛出异常(或元素不可复制)时搬移，否则复制，
+// 如此中途抛出异常时原区间仍完好(strong guarantee)；可逐位复制的元素直接memmove
+template <class InputIterator, class ForwardIterator>
+ForwardIterator __uninitialized_move_aux(InputIterator first, InputIterator last,
+                                         ForwardIterator result, true_type) {
+    ForwardIterator cur = result;
+    try {
+        for ( ; first != last; ++first, ++cur)
+            Construct(&*cur, std::move(*first));
+        return cur;
+    }
+    catch(...) {
+        Destroy(result, cur);
+        throw;
+    }
+}
+
+template <class InputIterator, class ForwardIterator>
+inline ForwardIterator __uninitialized_move_aux(InputIterator first, InputIterator last,
+                                                ForwardIterator result, false_type) {
+    return Uninitialized_copy(first, last, result);
+}
+
+template <class InputIterator, class ForwardIterator>
+inline ForwardIterator Uninitialized_move_if_noexcept(InputIterator first, InputIterator last,
+                                                      ForwardIterator result) {
+    typedef typename iterator_traits<InputIterator>::value_type value_type;
+    return __uninitialized_move_aux(first, last, result, integral_constant<bool,
+        !__memmove_copyable<InputIterator, ForwardIterator>::type::value &&
+        (is_nothrow_move_constructible<value_type>::value ||
+         !is_copy_constructible<value_type>::value)>());
 }
 
-#endif
\ No newline at end of file
+#endif
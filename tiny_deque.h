@@ -1,22 +1,60 @@
 #ifndef __TINY_DEQUE_H
 #define __TINY_DEQUE_H
+#include <algorithm>
 #include <iterator>
 #include <memory>
+#include <cstring>
+#include <type_traits>
 #include "tiny_construct.h"
 #include "tiny_alloc.h"
 
+// 默认缓冲区的目标大小(bytes)，与缓冲区应为其整数倍的cache line大小
+#ifndef __TINY_DEQUE_BUF_BYTES
+#   define __TINY_DEQUE_BUF_BYTES ((size_t)512)
+#endif
+#ifndef __TINY_DEQUE_CACHE_LINE
+#   define __TINY_DEQUE_CACHE_LINE ((size_t)64)
+#endif
+// 为凑成cache line的整数倍而放大缓冲区时，放大后不得超过此大小(bytes)
+#ifndef __TINY_DEQUE_BUF_MAX_BYTES
+#   define __TINY_DEQUE_BUF_MAX_BYTES ((size_t)4096)
+#endif
+
+// 不大于n的最大的2的幂(n > 0)
+constexpr size_t __deque_floor_pow2(size_t n) {
+    return (n & (n - 1)) == 0 ? n : __deque_floor_pow2(n & (n - 1));
+}
+constexpr bool __deque_is_pow2(size_t n) { return n != 0 && (n & (n - 1)) == 0; }
+constexpr int __deque_log2(size_t n) { return n <= 1 ? 0 : 1 + __deque_log2(n >> 1); }
+// 大小为sz的元素至少要几个才能凑成cache line的整数倍，结果必为2的幂
+constexpr size_t __deque_line_elems(size_t sz) {
+    return (sz & (~sz + 1)) >= __TINY_DEQUE_CACHE_LINE ? 1
+           : __TINY_DEQUE_CACHE_LINE / (sz & (~sz + 1));
+}
+constexpr size_t __deque_pow2_buf_size(size_t count, size_t line, size_t sz) {
+    return count < line && line * sz <= __TINY_DEQUE_BUF_MAX_BYTES ? line : count;
+}
+
 // 如果n不为0，传回n，表示buffer size由用户自定义
-// 如果n为0，表示buffer size使用默认值，那么
-// 如果sz(元素大小，sizeof(value_type))小于512，传回512/sz，如果sz不小于512，传回1
-inline size_t __deque_buf_size(size_t n,size_t sz) {
-    return n != 0 ? n : (sz < 512 ? size_t(512 / sz) : size_t(1));
+// 如果n为0，表示buffer size使用默认值：不超过512 bytes的最大的2的幂个元素(至少1个)，
+// 使迭代器的随机存取只需移位与遮罩；若这样的缓冲区不是cache line的整数倍，
+// 且放大到整数倍后不超过4096 bytes，就放大到整数倍
+constexpr size_t __deque_buf_size(size_t n,size_t sz) {
+    return n != 0 ? n
+           : __deque_pow2_buf_size(__deque_floor_pow2(sz < __TINY_DEQUE_BUF_BYTES ? __TINY_DEQUE_BUF_BYTES / sz : 1),
+                                   __deque_line_elems(sz), sz);
 }
 
+// deque默认最多保留几个空闲缓冲区以备重用，可由set_spare_capacity在执行期调整
+#ifndef __TINY_DEQUE_SPARE_NODES
+#   define __TINY_DEQUE_SPARE_NODES 2
+#endif
+
 template <class T,class Ref,class Ptr,size_t BufSiz>
 struct __deque_iterator {   // 为继承std::iterator
     typedef __deque_iterator<T, T &, T *, BufSiz> iterator;
     typedef __deque_iterator<T, const T &, const T *, BufSiz> const_iterator;
-    static size_t buffer_size() { return __deque_buf_size(BufSiz, sizeof(T)); }
+    static constexpr size_t buffer_size() { return __deque_buf_size(BufSiz, sizeof(T)); }
 
     // 未继承std::iterator，所以必须自行撰写五个必要的迭代器相应型别
     typedef random_access_iterator_tag iterator_category;
@@ -44,12 +82,12 @@ struct __deque_iterator {   // 为继承std::iterator
     // 重载运算子
     reference operator*() const { return *cur; }
     pointer operator->() const { return &(operator*()); }
-    // 其中 (node - x.node - 1)计算两个迭代器之间完整buffer的长度
-    // (cur - first)计算末尾buffer的元素量
-    // (x.last - x.cur)计算起始buffer的元素量
+    // 其中 (node - x.node)计算两个迭代器所在buffer的起点之间的长度
+    // (cur - first)与(x.cur - x.first)分别是两者在各自buffer内的位置
+    // 未配置空间的空deque的迭代器都是0，相减得0
     difference_type operator-(const self& x) const {
-        return difference_type(buffer_size()) * (node - x.node - 1) + 
-        (cur - first) + (x.last - x.cur);
+        return difference_type(buffer_size()) * (node - x.node) +
+        (cur - first) - (x.cur - x.first);
     }
 
     self& operator++() {
@@ -87,6 +125,12 @@ struct __deque_iterator {   // 为继承std::iterator
             cur += n;
         else {
             // 标的位置不在同一缓冲区
+            if (__deque_is_pow2(buffer_size())) {
+                // 缓冲区大小是2的幂：算术右移即向下取整的除法，遮罩即余数
+                set_node(node + (offset >> __deque_log2(buffer_size())));
+                cur = first + (offset & difference_type(buffer_size() - 1));
+                return *this;
+            }
             difference_type node_offset =
                 offset > 0 ? offset / difference_type(buffer_size()) 
                 : -difference_type((-offset - 1) / buffer_size()) - 1;
@@ -122,8 +166,417 @@ struct __deque_iterator {   // 为继承std::iterator
 
 };
 
-template<class T,size_t BufSiz = 0>
-class deque {
+// 分段迭代器协议：deque的空间由多个缓冲区组成，每个缓冲区是一段连续空间[begin(s),end(s))
+// segment(it)传回it所在的段，local(it)传回it在段内的指针，compose(s,p)由两者还原迭代器
+// 以下算法逐段把工作交给指针版本(memmove、memset或可向量化的循环)，
+// 省去operator++在每个元素上检查是否到达缓冲区尾端
+template <class Iterator>
+struct __segmented_iterator_traits;
+
+template <class T, class Ref, class Ptr, size_t BufSiz>
+struct __segmented_iterator_traits<__deque_iterator<T, Ref, Ptr, BufSiz> > {
+    typedef __deque_iterator<T, Ref, Ptr, BufSiz> iterator;
+    typedef typename iterator::map_pointer segment_iterator;
+    typedef Ptr local_iterator;
+
+    static segment_iterator segment(const iterator& it) { return it.node; }
+    static local_iterator local(const iterator& it) { return it.cur; }
+    static local_iterator begin(segment_iterator s) { return *s; }
+    static local_iterator end(segment_iterator s) { return *s + iterator::buffer_size(); }
+    static iterator compose(segment_iterator s, local_iterator p) {
+        iterator it;
+        it.set_node(s);
+        it.cur = const_cast<T*>(p);
+        return it;
+    }
+};
+
+// 源是分段迭代器：逐段复制到result
+template <class SegIter, class OutputIterator>
+OutputIterator __segmented_copy(SegIter first, SegIter last, OutputIterator result) {
+    typedef __segmented_iterator_traits<SegIter> Traits;
+    typename Traits::segment_iterator sf = Traits::segment(first);
+    typename Traits::segment_iterator sl = Traits::segment(last);
+    if (sf == sl)
+        return std::copy(Traits::local(first), Traits::local(last), result);
+    result = std::copy(Traits::local(first), Traits::end(sf), result);
+    for (++sf; sf != sl; ++sf)
+        result = std::copy(Traits::begin(sf), Traits::end(sf), result);
+    return std::copy(Traits::begin(sl), Traits::local(last), result);
+}
+
+// 目的是分段迭代器，源是随机存取迭代器：按目的端的段切分
+template <class RandomAccessIterator, class SegIter>
+SegIter __copy_to_segmented(RandomAccessIterator first, RandomAccessIterator last, SegIter result) {
+    typedef __segmented_iterator_traits<SegIter> Traits;
+    typedef typename iterator_traits<RandomAccessIterator>::difference_type difference_type;
+    if (first == last)      // result可能是未配置空间的空deque的迭代器
+        return result;
+    typename Traits::segment_iterator s = Traits::segment(result);
+    typename Traits::local_iterator p = Traits::local(result);
+    for (difference_type n = last - first; n > 0; ) {
+        difference_type len = Traits::end(s) - p;
+        if (n < len)
+            len = n;
+        std::copy(first, first + len, p);
+        first += len;
+        n -= len;
+        p += len;
+        if (p == Traits::end(s)) {      // 与operator++相同，段尾即下一段的开头
+            ++s;
+            p = Traits::begin(s);
+        }
+    }
+    return Traits::compose(s, p);
+}
+
+// 源与目的都是分段迭代器，由后往前逐段复制；每段取两端所在段剩余长度的较小者
+template <class SegIter1, class SegIter2>
+SegIter2 __segmented_copy_backward(SegIter1 first, SegIter1 last, SegIter2 result) {
+    typedef __segmented_iterator_traits<SegIter1> Traits1;
+    typedef __segmented_iterator_traits<SegIter2> Traits2;
+    typedef typename iterator_traits<SegIter1>::difference_type difference_type;
+    for (difference_type n = last - first; n > 0; ) {
+        typename Traits1::segment_iterator ls = Traits1::segment(last);
+        typename Traits1::local_iterator le = Traits1::local(last);
+        if (le == Traits1::begin(ls))
+            le = Traits1::end(--ls);
+        typename Traits2::segment_iterator rs = Traits2::segment(result);
+        typename Traits2::local_iterator re = Traits2::local(result);
+        if (re == Traits2::begin(rs))
+            re = Traits2::end(--rs);
+        difference_type len = le - Traits1::begin(ls);
+        if (re - Traits2::begin(rs) < len)
+            len = re - Traits2::begin(rs);
+        if (n < len)
+            len = n;
+        std::copy_backward(le - len, le, re);
+        last = Traits1::compose(ls, le - len);
+        result = Traits2::compose(rs, re - len);
+        n -= len;
+    }
+    return result;
+}
+
+template <class SegIter, class T>
+void __segmented_fill(SegIter first, SegIter last, const T& value) {
+    typedef __segmented_iterator_traits<SegIter> Traits;
+    typename Traits::segment_iterator sf = Traits::segment(first);
+    typename Traits::segment_iterator sl = Traits::segment(last);
+    if (sf == sl) {
+        std::fill(Traits::local(first), Traits::local(last), value);
+        return;
+    }
+    std::fill(Traits::local(first), Traits::end(sf), value);
+    for (++sf; sf != sl; ++sf)
+        std::fill(Traits::begin(sf), Traits::end(sf), value);
+    std::fill(Traits::begin(sl), Traits::local(last), value);
+}
+
+template <class SegIter, class T>
+SegIter __segmented_find(SegIter first, SegIter last, const T& value) {
+    typedef __segmented_iterator_traits<SegIter> Traits;
+    if (first == last)
+        return last;
+    typename Traits::segment_iterator sf = Traits::segment(first);
+    typename Traits::segment_iterator sl = Traits::segment(last);
+    typename Traits::local_iterator p;
+    if (sf != sl) {
+        p = std::find(Traits::local(first), Traits::end(sf), value);
+        if (p != Traits::end(sf))
+            return Traits::compose(sf, p);
+        for (++sf; sf != sl; ++sf) {
+            p = std::find(Traits::begin(sf), Traits::end(sf), value);
+            if (p != Traits::end(sf))
+                return Traits::compose(sf, p);
+        }
+        first = Traits::compose(sl, Traits::begin(sl));
+    }
+    p = std::find(Traits::local(first), Traits::local(last), value);
+    return Traits::compose(sl, p);
+}
+
+// 源是随机存取迭代器，与分段迭代器first2比较：按first2的段切分
+template <class RandomAccessIterator, class SegIter>
+bool __equal_to_segmented(RandomAccessIterator first1, RandomAccessIterator last1, SegIter first2) {
+    typedef __segmented_iterator_traits<SegIter> Traits;
+    typedef typename iterator_traits<RandomAccessIterator>::difference_type difference_type;
+    typename Traits::segment_iterator s = Traits::segment(first2);
+    typename Traits::local_iterator p = Traits::local(first2);
+    for (difference_type n = last1 - first1; n > 0; ) {
+        difference_type len = Traits::end(s) - p;
+        if (n < len)
+            len = n;
+        if (!std::equal(first1, first1 + len, p))
+            return false;
+        first1 += len;
+        n -= len;
+        if (n > 0)
+            p = Traits::begin(++s);
+    }
+    return true;
+}
+
+// 逐段比较，每段交给Compare处理：Compare(first1, last1, first2)传回该段是否相等
+template <class SegIter, class InputIterator, class Compare>
+bool __segmented_equal(SegIter first1, SegIter last1, InputIterator first2, Compare compare) {
+    typedef __segmented_iterator_traits<SegIter> Traits;
+    typename Traits::segment_iterator sf = Traits::segment(first1);
+    typename Traits::segment_iterator sl = Traits::segment(last1);
+    if (sf == sl)
+        return compare(Traits::local(first1), Traits::local(last1), first2);
+    if (!compare(Traits::local(first1), Traits::end(sf), first2))
+        return false;
+    std::advance(first2, Traits::end(sf) - Traits::local(first1));
+    for (++sf; sf != sl; ++sf) {
+        if (!compare(Traits::begin(sf), Traits::end(sf), first2))
+            return false;
+        std::advance(first2, Traits::end(sf) - Traits::begin(sf));
+    }
+    return compare(Traits::begin(sl), Traits::local(last1), first2);
+}
+
+struct __equal_contiguous {
+    template <class Ptr, class InputIterator>
+    bool operator()(Ptr first1, Ptr last1, InputIterator first2) const {
+        return std::equal(first1, last1, first2);
+    }
+};
+
+struct __equal_to_segmented_contiguous {
+    template <class Ptr, class SegIter>
+    bool operator()(Ptr first1, Ptr last1, SegIter first2) const {
+        return __equal_to_segmented(first1, last1, first2);
+    }
+};
+
+// 与accumulate的泛化版本相同，以init + *first累加
+struct __accumulate_plus {
+    template <class T, class U>
+    T operator()(const T& x, const U& y) const { return x + y; }
+};
+
+template <class SegIter, class T, class BinaryOperation>
+T __segmented_accumulate(SegIter first, SegIter last, T init, BinaryOperation binary_op) {
+    typedef __segmented_iterator_traits<SegIter> Traits;
+    typedef typename Traits::local_iterator local_iterator;
+    typename Traits::segment_iterator sf = Traits::segment(first);
+    typename Traits::segment_iterator sl = Traits::segment(last);
+    if (sf != sl) {
+        for (local_iterator p = Traits::local(first), e = Traits::end(sf); p != e; ++p)
+            init = binary_op(init, *p);
+        for (++sf; sf != sl; ++sf)
+            for (local_iterator p = Traits::begin(sf), e = Traits::end(sf); p != e; ++p)
+                init = binary_op(init, *p);
+        first = Traits::compose(sl, Traits::begin(sl));
+    }
+    for (local_iterator p = Traits::local(first), e = Traits::local(last); p != e; ++p)
+        init = binary_op(init, *p);
+    return init;
+}
+
+// 以下以__deque_iterator重载的算法比泛化版本(包括std中的)更特殊，
+// 对deque迭代器的调用会选中它们，转交给上面的分段版本
+
+template <class T, class Ref, class Ptr, size_t BufSiz, class OutputIterator>
+inline OutputIterator copy(__deque_iterator<T, Ref, Ptr, BufSiz> first,
+                           __deque_iterator<T, Ref, Ptr, BufSiz> last, OutputIterator result) {
+    return __segmented_copy(first, last, result);
+}
+
+template <class U, class T, size_t BufSiz>
+inline __deque_iterator<T, T&, T*, BufSiz>
+copy(U* first, U* last, __deque_iterator<T, T&, T*, BufSiz> result) {
+    return __copy_to_segmented(first, last, result);
+}
+
+// 源与目的都是deque：逐个源段交给__copy_to_segmented
+template <class T, class Ref, class Ptr, size_t BufSiz>
+__deque_iterator<T, T&, T*, BufSiz>
+copy(__deque_iterator<T, Ref, Ptr, BufSiz> first, __deque_iterator<T, Ref, Ptr, BufSiz> last,
+     __deque_iterator<T, T&, T*, BufSiz> result) {
+    typedef __segmented_iterator_traits<__deque_iterator<T, Ref, Ptr, BufSiz> > Traits;
+    typename Traits::segment_iterator sf = Traits::segment(first);
+    typename Traits::segment_iterator sl = Traits::segment(last);
+    if (sf == sl)
+        return __copy_to_segmented(Traits::local(first), Traits::local(last), result);
+    result = __copy_to_segmented(Traits::local(first), Traits::end(sf), result);
+    for (++sf; sf != sl; ++sf)
+        result = __copy_to_segmented(Traits::begin(sf), Traits::end(sf), result);
+    return __copy_to_segmented(Traits::begin(sl), Traits::local(last), result);
+}
+
+template <class T, class Ref, class Ptr, size_t BufSiz>
+inline __deque_iterator<T, T&, T*, BufSiz>
+copy_backward(__deque_iterator<T, Ref, Ptr, BufSiz> first, __deque_iterator<T, Ref, Ptr, BufSiz> last,
+              __deque_iterator<T, T&, T*, BufSiz> result) {
+    return __segmented_copy_backward(first, last, result);
+}
+
+template <class T, size_t BufSiz, class U>
+inline void fill(__deque_iterator<T, T&, T*, BufSiz> first,
+                 __deque_iterator<T, T&, T*, BufSiz> last, const U& value) {
+    __segmented_fill(first, last, value);
+}
+
+template <class T, class Ref, class Ptr, size_t BufSiz, class U>
+inline __deque_iterator<T, Ref, Ptr, BufSiz>
+find(__deque_iterator<T, Ref, Ptr, BufSiz> first, __deque_iterator<T, Ref, Ptr, BufSiz> last,
+     const U& value) {
+    return __segmented_find(first, last, value);
+}
+
+template <class T, class Ref, class Ptr, size_t BufSiz, class InputIterator>
+inline bool equal(__deque_iterator<T, Ref, Ptr, BufSiz> first1,
+                  __deque_iterator<T, Ref, Ptr, BufSiz> last1, InputIterator first2) {
+    return __segmented_equal(first1, last1, first2, __equal_contiguous());
+}
+
+template <class T1, class Ref1, class Ptr1, size_t BufSiz1,
+          class T2, class Ref2, class Ptr2, size_t BufSiz2>
+inline bool equal(__deque_iterator<T1, Ref1, Ptr1, BufSiz1> first1,
+                  __deque_iterator<T1, Ref1, Ptr1, BufSiz1> last1,
+                  __deque_iterator<T2, Ref2, Ptr2, BufSiz2> first2) {
+    return __segmented_equal(first1, last1, first2, __equal_to_segmented_contiguous());
+}
+
+template <class T, class Ref, class Ptr, size_t BufSiz, class U>
+inline U accumulate(__deque_iterator<T, Ref, Ptr, BufSiz> first,
+                    __deque_iterator<T, Ref, Ptr, BufSiz> last, U init) {
+    return __segmented_accumulate(first, last, init, __accumulate_plus());
+}
+
+template <class T, class Ref, class Ptr, size_t BufSiz, class U, class BinaryOperation>
+inline U accumulate(__deque_iterator<T, Ref, Ptr, BufSiz> first,
+                    __deque_iterator<T, Ref, Ptr, BufSiz> last, U init, BinaryOperation binary_op) {
+    return __segmented_accumulate(first, last, init, binary_op);
+}
+
+// 以下是__deque_iterator区间上的未初始化复制与填充
+// deque的空间由多个缓冲区组成，逐段(每段是一个缓冲区内的连续空间)交给指针版本处理，
+// 可逐位复制的元素每段只需一次memmove/memset
+
+// 目的是deque，源是随机存取迭代器：按目的缓冲区分段
+template <class InputIterator, class T, size_t BufSiz>
+__deque_iterator<T, T&, T*, BufSiz>
+__uninitialized_copy_to_deque(InputIterator first, InputIterator last,
+                              __deque_iterator<T, T&, T*, BufSiz> result,
+                              random_access_iterator_tag) {
+    typedef typename __deque_iterator<T, T&, T*, BufSiz>::difference_type difference_type;
+    __deque_iterator<T, T&, T*, BufSiz> cur = result;
+    try {
+        for (difference_type n = last - first; n > 0; ) {
+            difference_type len = cur.last - cur.cur;   // 目前缓冲区的剩余空间
+            if (n < len)
+                len = n;
+            Uninitialized_copy(first, first + len, cur.cur);
+            first += len;
+            cur += len;
+            n -= len;
+        }
+        return cur;
+    }
+    catch(...) {
+        Destroy(result, cur);
+        throw;
+    }
+}
+
+// 目的是deque，源只能逐一前进：逐一构造
+template <class InputIterator, class T, size_t BufSiz>
+inline __deque_iterator<T, T&, T*, BufSiz>
+__uninitialized_copy_to_deque(InputIterator first, InputIterator last,
+                              __deque_iterator<T, T&, T*, BufSiz> result,
+                              input_iterator_tag) {
+    return __uninitialized_copy_aux(first, last, result, false_type());
+}
+
+template <class InputIterator, class T, size_t BufSiz>
+inline __deque_iterator<T, T&, T*, BufSiz>
+Uninitialized_copy(InputIterator first, InputIterator last,
+                   __deque_iterator<T, T&, T*, BufSiz> result) {
+    return __uninitialized_copy_to_deque(first, last, result,
+        typename iterator_traits<InputIterator>::iterator_category());
+}
+
+// 源是deque：按源缓冲区分段
+template <class T, class Ref, class Ptr, size_t BufSiz, class ForwardIterator>
+ForwardIterator Uninitialized_copy(__deque_iterator<T, Ref, Ptr, BufSiz> first,
+                                   __deque_iterator<T, Ref, Ptr, BufSiz> last,
+                                   ForwardIterator result) {
+    typedef typename __deque_iterator<T, Ref, Ptr, BufSiz>::difference_type difference_type;
+    ForwardIterator cur = result;
+    try {
+        for (difference_type n = last - first; n > 0; ) {
+            difference_type len = first.last - first.cur;   // 源缓冲区的剩余元素
+            if (n < len)
+                len = n;
+            cur = Uninitialized_copy(first.cur, first.cur + len, cur);
+            first += len;
+            n -= len;
+        }
+        return cur;
+    }
+    catch(...) {
+        Destroy(result, cur);
+        throw;
+    }
+}
+
+// 源与目的都是deque：每段取源与目的缓冲区剩余空间的较小者
+template <class T, class Ref, class Ptr, size_t BufSiz>
+__deque_iterator<T, T&, T*, BufSiz>
+Uninitialized_copy(__deque_iterator<T, Ref, Ptr, BufSiz> first,
+                   __deque_iterator<T, Ref, Ptr, BufSiz> last,
+                   __deque_iterator<T, T&, T*, BufSiz> result) {
+    typedef typename __deque_iterator<T, Ref, Ptr, BufSiz>::difference_type difference_type;
+    __deque_iterator<T, T&, T*, BufSiz> cur = result;
+    try {
+        for (difference_type n = last - first; n > 0; ) {
+            difference_type len = first.last - first.cur;
+            if (cur.last - cur.cur < len)
+                len = cur.last - cur.cur;
+            if (n < len)
+                len = n;
+            Uninitialized_copy(first.cur, first.cur + len, cur.cur);
+            first += len;
+            cur += len;
+            n -= len;
+        }
+        return cur;
+    }
+    catch(...) {
+        Destroy(result, cur);
+        throw;
+    }
+}
+
+// 在deque的[first,last)上构造x的副本：按缓冲区分段
+template <class T, size_t BufSiz>
+void Uninitialized_fill(__deque_iterator<T, T&, T*, BufSiz> first,
+                        __deque_iterator<T, T&, T*, BufSiz> last, const T& x) {
+    __deque_iterator<T, T&, T*, BufSiz> cur = first;
+    try {
+        for ( ; cur.node != last.node; cur.set_node(cur.node + 1), cur.cur = cur.first)
+            Uninitialized_fill(cur.cur, cur.last, x);
+        Uninitialized_fill(cur.cur, last.cur, x);
+    }
+    catch(...) {
+        Destroy(first, cur);
+        throw;
+    }
+}
+
+template <class T, size_t BufSiz, class Size>
+inline __deque_iterator<T, T&, T*, BufSiz>
+Uninitialized_fill_n(__deque_iterator<T, T&, T*, BufSiz> first, Size n, const T& x) {
+    __deque_iterator<T, T&, T*, BufSiz> last = first + n;
+    Uninitialized_fill(first, last, x);
+    return last;
+}
+
+template<class T, class Alloc = alloc, size_t BufSiz = 0>
+class deque : protected simple_alloc<T, Alloc> {
     public:
         typedef T value_type;
         typedef value_type *pointer;
@@ -132,32 +585,100 @@ class deque {
         typedef const value_type& const_reference;
         typedef size_t size_type;
         typedef ptrdiff_t difference_type;
+        typedef Alloc allocator_type;
     
     public:
         typedef __deque_iterator<T, T &, T *, BufSiz> iterator;
 
         // construct
         // 默认析构函数
-        explicit deque() { fill_initialize(0, 0); }
-        deque(int n, const value_type &value) : start(), finish(), map(0), map_size(0) {
+        // 空deque不配置任何空间：map为0，start与finish都是0迭代器，
+        // 第一次加入元素时才配置map与第一个缓冲区
+        deque() : start(), finish(), map(0), map_size(0),
+            spare_nodes(0), spare_count(0), spare_cap(__TINY_DEQUE_SPARE_NODES) {}
+        explicit deque(const allocator_type& a) : data_allocator(a), start(), finish(), map(0), map_size(0),
+            spare_nodes(0), spare_count(0), spare_cap(__TINY_DEQUE_SPARE_NODES) {}
+        deque(int n, const value_type &value, const allocator_type& a = allocator_type())
+            : data_allocator(a), start(), finish(), map(0), map_size(0),
+              spare_nodes(0), spare_count(0), spare_cap(__TINY_DEQUE_SPARE_NODES) {
             fill_initialize(n, value);
         }
-        explicit deque(size_type n) { fill_initialize(n,value_type()); }
-        ~deque() { Destroy(start, finish); }
+        explicit deque(size_type n) : start(), finish(), map(0), map_size(0),
+            spare_nodes(0), spare_count(0), spare_cap(__TINY_DEQUE_SPARE_NODES) { fill_initialize(n,value_type()); }
+        // 拷贝构造函数，配置器与空闲缓冲区的上限随之复制，空闲缓冲区本身不复制
+        deque(const deque& x) : data_allocator(x), start(), finish(), map(0), map_size(0),
+            spare_nodes(0), spare_count(0), spare_cap(x.spare_cap) {
+            if (x.empty())
+                return;
+            create_map_and_nodes(x.size());
+            try {
+                Uninitialized_copy(x.start, x.finish, start);
+            }
+            catch(...) {
+                destroy_map_and_nodes();
+                throw;
+            }
+        }
+        // 析构函数，析构所有元素后归还每个缓冲区及map
+        ~deque() {
+            Destroy(start, finish);
+            destroy_map_and_nodes();
+        }
+
+        deque& operator=(const deque& x) {
+            if (this != &x) {
+                deque tmp(x);
+                swap(tmp);
+            }
+            return *this;
+        }
+
+        // 配置器与空闲缓冲区随缓冲区一起交换
+        void swap(deque& x) {
+            std::swap((data_allocator&)*this, (data_allocator&)x);
+            std::swap(start, x.start);
+            std::swap(finish, x.finish);
+            std::swap(map, x.map);
+            std::swap(map_size, x.map_size);
+            std::swap(spare_nodes, x.spare_nodes);
+            std::swap(spare_count, x.spare_count);
+            std::swap(spare_cap, x.spare_cap);
+        }
+
+        // 最多保留几个空闲缓冲区；调低时立即归还多出的部分，设为0即不保留
+        size_type spare_capacity() const { return spare_cap; }
+        void set_spare_capacity(size_type n) {
+            spare_cap = n;
+            while (spare_count > spare_cap)
+                data_allocator::deallocate(pop_spare_node(), buffer_size());
+        }
+        // 归还所有空闲缓冲区；deque为空时连同map与仅剩的缓冲区一并归还，回到未配置空间的状态
+        void shrink_to_fit() {
+            if (empty() && map) {
+                destroy_map_and_nodes();
+                start = finish = iterator();
+                map = 0;
+                map_size = 0;
+            }
+            else
+                release_spare_nodes();
+        }
+
+        allocator_type get_allocator() const { return data_allocator::get_allocator(); }
 
 
     protected:
         // 元素的指针的指针
         typedef pointer *map_pointer;
-        static size_t buffer_size() { return __deque_buf_size(BufSiz,sizeof(T)); }
+        static constexpr size_t buffer_size() { return __deque_buf_size(BufSiz,sizeof(T)); }
 
         void initialize_map(size_t);
         enum { initial_map_size = 8 };
 
-        // 专属空间配置器，每次只配置一个元素大小
-        typedef simple_alloc<value_type> data_allocator;
-        // 专属空间配置器，每次只配置一个指针大小
-        typedef simple_alloc<pointer> map_allocator;
+        // 专属空间配置器，每次只配置一个元素大小，deque继承它以保存Alloc
+        typedef simple_alloc<value_type, Alloc> data_allocator;
+        // 专属空间配置器，每次只配置一个指针大小，用时以deque的Alloc临时构造
+        typedef simple_alloc<pointer, Alloc> map_allocator;
 
     protected:
         iterator start;     // 表现的第一个节点
@@ -167,21 +688,60 @@ class deque {
         // 其每个元素都是指针，指向一个节点(缓冲区)
         size_type map_size;     // map内指针数
 
+        // 空闲缓冲区：pop时腾空的缓冲区先留下，下次push需要新缓冲区时直接取用，
+        // 队列式的使用(一端进另一端出)因此不必反复配置与归还缓冲区
+        // 空闲缓冲区以其开头存放的指针串成单向链表，不另占空间
+        T* spare_nodes;         // 链表头
+        size_type spare_count;  // 空闲缓冲区的个数
+        size_type spare_cap;    // 空闲缓冲区个数的上限
+
         void fill_initialize(size_type n, const value_type &value);
         void create_map_and_nodes(size_type num_elements);
+        void release_spare_nodes() {
+            while (spare_count > 0)
+                data_allocator::deallocate(pop_spare_node(), buffer_size());
+        }
+        // 归还[start.node, finish.node]的每个缓冲区、所有空闲缓冲区及map本身
+        void destroy_map_and_nodes() {
+            release_spare_nodes();
+            if (map) {
+                for (map_pointer cur = start.node; cur <= finish.node; ++cur)
+                    data_allocator::deallocate(*cur, buffer_size());
+                deallocate_map(map, map_size);
+            }
+        }
+
+        // 缓冲区至少要放得下一个指针，才能串进空闲链表
+        static bool node_can_be_spare() { return buffer_size() * sizeof(T) >= sizeof(T*); }
+        T* pop_spare_node() {
+            T* p = spare_nodes;
+            memcpy(&spare_nodes, p, sizeof(T*));
+            --spare_count;
+            return p;
+        }
 
-        // 分配节点
-        T* allocate_node()
-            { return data_allocator::allocate(__deque_buf_size(BufSiz,sizeof(T))); }
-        // 销毁节点
-        void deallocate_node(T* p)
-            { data_allocator::deallocate(p, __deque_buf_size(BufSiz,sizeof(T))); }
-        // 分配缓冲区
-        T** allocate_map(size_t n) 
-            { return map_allocator::allocate(n); }
+        // 分配节点，有空闲缓冲区时优先取用
+        T* allocate_node() {
+            if (spare_count > 0)
+                return pop_spare_node();
+            return data_allocator::allocate(buffer_size());
+        }
+        // 销毁节点，空闲缓冲区未达上限时留下备用
+        void deallocate_node(T* p) {
+            if (spare_count < spare_cap && node_can_be_spare()) {
+                memcpy(p, &spare_nodes, sizeof(T*));
+                spare_nodes = p;
+                ++spare_count;
+            }
+            else
+                data_allocator::deallocate(p, buffer_size());
+        }
+        // 分配map，n改为实际可容纳的指针个数，多出的部分作为前后的备用节点
+        T** allocate_map(size_t &n) 
+            { return map_allocator(get_allocator()).allocate_at_least(n); }
         // 销毁缓冲区
         void deallocate_map(T** p, size_t n) 
-            { map_allocator::deallocate(p, n); }
+            { map_allocator(get_allocator()).deallocate(p, n); }
         
         // 确保在map的前后有空间放置新的节点
         void reserve_map_at_back (size_type nodes_to_add = 1) {
@@ -207,8 +767,57 @@ class deque {
         // 只有当第一个缓冲区仅有一个元素时才会被调用
         void pop_front_aux();
         // 插入元素操作
-        deque<T,BufSiz>::iterator insert_aux(iterator pos, const value_type &x);
-        deque<T, BufSiz>::iterator insert_aux(iterator pos);
+        iterator insert_aux(iterator pos, const value_type &x);
+        iterator insert_aux(iterator pos);
+
+        template <class Integer>
+        void insert_dispatch(iterator pos, Integer n, Integer x, true_type) {
+            fill_insert(pos, (size_type)n, (value_type)x);
+        }
+        template <class InputIterator>
+        void insert_dispatch(iterator pos, InputIterator first, InputIterator last, false_type) {
+            range_insert(pos, first, last, typename iterator_traits<InputIterator>::iterator_category());
+        }
+        void fill_insert(iterator pos, size_type n, const value_type& x);
+        template <class InputIterator>
+        void range_insert(iterator pos, InputIterator first, InputIterator last, input_iterator_tag);
+        template <class ForwardIterator>
+        void range_insert(iterator pos, ForwardIterator first, ForwardIterator last, forward_iterator_tag);
+        // 在中段插入n个元素，移动插入点前后元素较少的一方
+        void insert_aux(iterator pos, size_type n, const value_type& x);
+        template <class ForwardIterator>
+        void insert_aux(iterator pos, ForwardIterator first, ForwardIterator last, size_type n);
+
+        // 在前端(尾端)预留n个元素的空间，传回新的start(finish)，start与finish本身不变
+        // 所需的map节点一次备妥，缓冲区一次配置好
+        iterator reserve_elements_at_front(size_type n) {
+            if (map == 0)
+                create_map_and_nodes(0);
+            size_type vacancies = start.cur - start.first;
+            if (n > vacancies)
+                new_elements_at_front(n - vacancies);
+            return start - difference_type(n);
+        }
+        iterator reserve_elements_at_back(size_type n) {
+            if (map == 0)
+                create_map_and_nodes(0);
+            // 新的finish必须落在已配置的缓冲区中，所以最后缓冲区只算last-cur-1个备用空间
+            size_type vacancies = (finish.last - finish.cur) - 1;
+            if (n > vacancies)
+                new_elements_at_back(n - vacancies);
+            return finish + difference_type(n);
+        }
+        void new_elements_at_front(size_type new_elements);
+        void new_elements_at_back(size_type new_elements);
+        // 归还reserve_elements_at_front(back)配置而未用上的缓冲区
+        void destroy_nodes_at_front(iterator new_start) {
+            for (map_pointer n = new_start.node; n < start.node; ++n)
+                deallocate_node(*n);
+        }
+        void destroy_nodes_at_back(iterator new_finish) {
+            for (map_pointer n = finish.node + 1; n <= new_finish.node; ++n)
+                deallocate_node(*n);
+        }
 
     public:
         iterator begin() { return start; }
@@ -230,8 +839,8 @@ class deque {
         bool empty() const { return finish == start; }
         // 在deque后端加入一个元素
         void push_back(const value_type& t) {
-            if(finish.cur != finish.last-1) {
-                // 最后缓冲区尚有两个以上的元素备用空间
+            if(finish.last - finish.cur > 1) {
+                // 最后缓冲区尚有两个以上的元素备用空间(未配置空间时两者都是0)
                 Construct(finish.cur, t);   // 直接在备用空间上构造元素
                 ++finish.cur;       // 调整最后缓冲区的使用状态
             }
@@ -240,7 +849,7 @@ class deque {
         }
         // 在deque前端加入一个元素
         void push_front(const value_type& t) {
-            if(start.cur != start.first) {      // 第一缓冲区尚有备用空间
+            if(start.cur != start.first) {      // 第一缓冲区尚有备用空间(未配置空间时两者都是0)
                 Construct(start.cur - 1, t);    // 直接在备用空间上构造元素
                 --start.cur;        // 调整第一缓冲区的使用状态
             }
@@ -286,7 +895,7 @@ class deque {
             return start + index;
         }
 
-        deque<T,BufSiz>::iterator erase(iterator first,iterator last) {
+        iterator erase(iterator first,iterator last) {
             if(first == start && last == finish) {  // 如果清除区间就是整个deque
                 clear();    // 直接调用clear()即可
                 return finish;
@@ -300,7 +909,7 @@ class deque {
                     Destroy(start, new_start);      // 移动完毕，经冗余的元素析构
                     // 以下将冗余的缓冲区释放
                     for (map_pointer cur = start.node; cur < new_start.node;++cur)
-                        data_allocator::deallocate(*cur, buffer_size());
+                        deallocate_node(*cur);
                     start = new_start;
                 }
                 else {      // 如果清除区间后方的元素比较少
@@ -308,7 +917,7 @@ class deque {
                     iterator new_finish = finish - n;   // 标记deque的新尾点
                     Destroy(new_finish, finish);    // 移动完毕，将冗余元素析构
                     for (map_pointer cur = new_finish.node + 1; cur <= finish.node;++cur)
-                        data_allocator::deallocate(*cur, buffer_size());
+                        deallocate_node(*cur);
                     finish = new_finish;    // 设定deque的新尾节点
                 }
                 return start + elems_before;
@@ -331,24 +940,60 @@ class deque {
             }
         }
 
+        // 插入一个value_type()；在头尾时直接push，空deque亦然(insert_aux要借用front()或back())
         iterator insert(iterator pos) {
-            insert_aux(pos);
+            if (pos.cur == start.cur) {
+                push_front(value_type());
+                return start;
+            }
+            else if (pos.cur == finish.cur) {
+                push_back(value_type());
+                iterator tmp = finish;
+                --tmp;
+                return tmp;
+            }
+            else
+                return insert_aux(pos);
+        }
+        // 插入n个x：所需的缓冲区一次配置好，每个缓冲区以一次未初始化填充构造
+        void insert(iterator pos, size_type n, const value_type& x) { fill_insert(pos, n, x); }
+        // 插入[first,last)：前向迭代器先求出元素个数，所需的缓冲区一次配置好，
+        // 源为随机存取迭代器时每个缓冲区以一次未初始化复制构造
+        template <class InputIterator>
+        void insert(iterator pos, InputIterator first, InputIterator last) {
+            insert_dispatch(pos, first, last, is_integral<InputIterator>());
         }
+        // 在尾端(前端)批量加入[first,last)，元素保持原来的顺序
+        template <class InputIterator>
+        void push_back(InputIterator first, InputIterator last) { insert(finish, first, last); }
+        template <class InputIterator>
+        void push_front(InputIterator first, InputIterator last) { insert(start, first, last); }
+
+        void resize(size_type new_size, const value_type& x) {
+            const size_type len = size();
+            if (new_size < len)
+                erase(start + difference_type(new_size), finish);
+            else
+                fill_insert(finish, new_size - len, x);
+        }
+        void resize(size_type new_size) { resize(new_size, value_type()); }
 };
 
-template <class T, size_t BufSize>
-void deque<T, BufSize>::fill_initialize(size_type n, const value_type &value) {
+template <class T, class Alloc, size_t BufSiz>
+void deque<T, Alloc, BufSiz>::fill_initialize(size_type n, const value_type &value) {
+    if (n == 0)     // 不配置空间
+        return;
     create_map_and_nodes(n);    // 把queue的结构都产生并安排好
     map_pointer cur;
     // 为每个节点的缓冲区设定初值
     for (cur = start.node; cur < finish.node; ++cur)
-        uninitialized_fill(*cur, *cur + buffer_size(), value);
+        Uninitialized_fill(*cur, *cur + buffer_size(), value);
     // 最后一个节点的设定稍有不同(尾端可能有备用空间，不必设初值)
-    uninitialized_fill(finish.first, finish.cur, value);
+    Uninitialized_fill(finish.first, finish.cur, value);
 }
 
-template<class T,size_t BufSiz>
-void deque<T,BufSiz>::create_map_and_nodes(size_type num_elements) {
+template <class T, class Alloc, size_t BufSiz>
+void deque<T, Alloc, BufSiz>::create_map_and_nodes(size_type num_elements) {
     // 需要节点数=(元素个数/每个缓冲区可容纳的元素个数)
     // 如果刚好整除，会多分配一个节点
     size_type num_nodes = num_elements / buffer_size() + 1;
@@ -371,10 +1016,14 @@ void deque<T,BufSiz>::create_map_and_nodes(size_type num_elements) {
         for (cur = nstart; cur <= nfinish; ++cur)
             *cur = allocate_node();
     }
-    catch(const std::exception& e) {
-        // 若非全部成功，就一个不留
-        for (cur = nstart; cur <= nfinish; ++cur)
-            deallocate_node(*cur);
+    catch(...) {
+        // 若非全部成功，就一个不留：只归还已配置的[nstart, cur)，连同map一起，再把异常抛出
+        for (map_pointer n = nstart; n < cur; ++n)
+            data_allocator::deallocate(*n, buffer_size());
+        deallocate_map(map, map_size);
+        map = 0;
+        map_size = 0;
+        throw;
     }
     
 
@@ -386,8 +1035,13 @@ void deque<T,BufSiz>::create_map_and_nodes(size_type num_elements) {
     // 令cur指向这多配的一个节点(所对应之缓冲区)的起始处
 }
 
-template <class T, size_t BufSiz>
-void deque<T, BufSiz>::push_back_aux(const value_type& t) {
+template <class T, class Alloc, size_t BufSiz>
+void deque<T, Alloc, BufSiz>::push_back_aux(const value_type& t) {
+    if (map == 0) {     // 空deque第一次加入元素，配置map与第一个缓冲区
+        create_map_and_nodes(0);
+        push_back(t);
+        return;
+    }
     value_type t_copy = t;
     reserve_map_at_back();      // 若符合某种条件则必须重换一个map
     *(finish.node + 1) = allocate_node();   // 配置一个新节点
@@ -397,13 +1051,21 @@ void deque<T, BufSiz>::push_back_aux(const value_type& t) {
         finish.cur = finish.first;      // 设定finish的状态
     }
     catch(const std::exception& e) {
-        deallocate_node(*(finish.node) + 1);
+        deallocate_node(*(finish.node + 1));
         throw;
     }
 }
 
-template <class T, size_t BufSiz>
-void deque<T, BufSiz>::push_front_aux(const value_type& t) {
+template <class T, class Alloc, size_t BufSiz>
+void deque<T, Alloc, BufSiz>::push_front_aux(const value_type& t) {
+    if (map == 0) {
+        // 空deque第一次加入元素：配置map与第一个缓冲区，从缓冲区尾端往前放，
+        // 之后的push_front不必另配缓冲区
+        create_map_and_nodes(0);
+        start.cur = finish.cur = start.last - 1;
+        push_front(t);
+        return;
+    }
     value_type t_copy = t;
     reserve_map_at_front();     // 若符合某种条件则必须重换一个map
     *(start.node - 1) = allocate_node();    // 配置一个新节点
@@ -420,8 +1082,8 @@ void deque<T, BufSiz>::push_front_aux(const value_type& t) {
     }
 }
 
-template <class T, size_t BufSiz>
-void deque<T, BufSiz>::reallocate_map(size_type nodes_to_add, bool add_at_front)
+template <class T, class Alloc, size_t BufSiz>
+void deque<T, Alloc, BufSiz>::reallocate_map(size_type nodes_to_add, bool add_at_front)
 {
     size_type old_num_nodes = finish.node - start.node + 1;
     size_type new_num_nodes = old_num_nodes + nodes_to_add;
@@ -455,44 +1117,46 @@ void deque<T, BufSiz>::reallocate_map(size_type nodes_to_add, bool add_at_front)
     finish.set_node(new_nstart + old_num_nodes - 1);
 }
 
-template <class T,size_t BufSiz>
-void deque<T,BufSiz>::pop_back_aux() {
+template <class T, class Alloc, size_t BufSiz>
+void deque<T, Alloc, BufSiz>::pop_back_aux() {
     deallocate_node(finish.first);      // 释放最后一个缓冲区
     finish.set_node(finish.node - 1);   // 调整finish的状态，使指向上一个缓冲区的最后一个元素
     finish.cur = finish.last - 1;
     Destroy(finish.cur);        // 将该元素析构
 }
 
-template <class T,size_t BufSiz>
-void deque<T,BufSiz>::pop_front_aux() {
+template <class T, class Alloc, size_t BufSiz>
+void deque<T, Alloc, BufSiz>::pop_front_aux() {
     Destroy(start.cur);     // 将第一个缓冲区的第一个元素析构
     deallocate_node(start.first);   // 释放第一缓冲区
     start.set_node(start.node + 1);     // 调整start的状态，使指向下一个缓冲区的第一个元素
     start.cur = start.first;
 }
 
-template <class T,size_t BufSiz>
-void deque<T,BufSiz>::clear() {
+template <class T, class Alloc, size_t BufSiz>
+void deque<T, Alloc, BufSiz>::clear() {
+    if (map == 0)
+        return;
     // 以下针对头尾以为的每一个缓冲区，它们一定是饱满的
     for (map_pointer node = start.node + 1; node < finish.node;++node) {
         // 将缓冲区内的所有元素析构
         Destroy(*node, *node + buffer_size());
         // 释放缓冲区内存
-        data_allocator::deallocate(*node, buffer_size());
+        deallocate_node(*node);
     }
     if(start.node != finish.node) {     // 至少有头尾两个缓冲区
         Destroy(start.cur, start.last);    // 将头缓冲区的目前所在元素析构
-        Destroy(finish.cur, finish.cur);    // 将尾缓冲区的目前所有元素析构
+        Destroy(finish.first, finish.cur);    // 将尾缓冲区的目前所有元素析构
         // 以下释放尾缓冲区
-        data_allocator::deallocate(finish.first, buffer_size());
+        deallocate_node(finish.first);
     }
     else        // 只有一个缓冲区
-        Destroy(start.cur, start.cur);      // 将此唯一缓冲区内的所有元素析构
+        Destroy(start.cur, finish.cur);      // 将此唯一缓冲区内的所有元素析构
     finish = start;    // 调整状态
 }
 
-template <class T,size_t BufSiz>
-typename deque<T,BufSiz>::iterator deque<T,BufSiz>::insert_aux(iterator pos, const value_type &x) {
+template <class T, class Alloc, size_t BufSiz>
+typename deque<T, Alloc, BufSiz>::iterator deque<T, Alloc, BufSiz>::insert_aux(iterator pos, const value_type &x) {
     difference_type index = pos - start;    // 插入点之前的元素个数
     value_type x_copy = x;
     if(index < size() / 2) {        // 如果插入点之前的元素个数比较少
@@ -519,8 +1183,8 @@ typename deque<T,BufSiz>::iterator deque<T,BufSiz>::insert_aux(iterator pos, con
     return pos;
 }
 
-template <class T,size_t BufSiz>
-typename deque<T,BufSiz>::iterator deque<T,BufSiz>::insert_aux(iterator pos)
+template <class T, class Alloc, size_t BufSiz>
+typename deque<T, Alloc, BufSiz>::iterator deque<T, Alloc, BufSiz>::insert_aux(iterator pos)
 {
     difference_type index = pos - start;
     if (index < size() / 2) {
@@ -547,16 +1211,277 @@ typename deque<T,BufSiz>::iterator deque<T,BufSiz>::insert_aux(iterator pos)
     return pos;
 }
 
+template <class T, class Alloc, size_t BufSiz>
+void deque<T, Alloc, BufSiz>::new_elements_at_front(size_type new_elements) {
+    size_type new_nodes = (new_elements + buffer_size() - 1) / buffer_size();
+    reserve_map_at_front(new_nodes);
+    size_type i;
+    try {
+        for (i = 1; i <= new_nodes; ++i)
+            *(start.node - i) = allocate_node();
+    }
+    catch(...) {
+        for (size_type j = 1; j < i; ++j)
+            deallocate_node(*(start.node - j));
+        throw;
+    }
+}
+
+template <class T, class Alloc, size_t BufSiz>
+void deque<T, Alloc, BufSiz>::new_elements_at_back(size_type new_elements) {
+    size_type new_nodes = (new_elements + buffer_size() - 1) / buffer_size();
+    reserve_map_at_back(new_nodes);
+    size_type i;
+    try {
+        for (i = 1; i <= new_nodes; ++i)
+            *(finish.node + i) = allocate_node();
+    }
+    catch(...) {
+        for (size_type j = 1; j < i; ++j)
+            deallocate_node(*(finish.node + j));
+        throw;
+    }
+}
+
+// 插入n个x：在头尾时直接在预留的空间上构造，否则交给insert_aux
+template <class T, class Alloc, size_t BufSiz>
+void deque<T, Alloc, BufSiz>::fill_insert(iterator pos, size_type n, const value_type& x) {
+    if (n == 0)
+        return;
+    if (pos.cur == start.cur) {
+        iterator new_start = reserve_elements_at_front(n);
+        try {
+            Uninitialized_fill(new_start, start, x);
+            start = new_start;
+        }
+        catch(...) {
+            destroy_nodes_at_front(new_start);
+            throw;
+        }
+    }
+    else if (pos.cur == finish.cur) {
+        iterator new_finish = reserve_elements_at_back(n);
+        try {
+            Uninitialized_fill(finish, new_finish, x);
+            finish = new_finish;
+        }
+        catch(...) {
+            destroy_nodes_at_back(new_finish);
+            throw;
+        }
+    }
+    else
+        insert_aux(pos, n, x);
+}
+
+// 插入输入迭代器的区间：元素个数无法预知，在尾端时逐一push_back；
+// 否则先收集到临时deque，再一次插入
+template <class T, class Alloc, size_t BufSiz>
+template <class InputIterator>
+void deque<T, Alloc, BufSiz>::range_insert(iterator pos, InputIterator first,
+                                           InputIterator last, input_iterator_tag) {
+    if (pos.cur == finish.cur) {
+        for ( ; first != last; ++first)
+            push_back(*first);
+    }
+    else {
+        deque tmp(get_allocator());
+        for ( ; first != last; ++first)
+            tmp.push_back(*first);
+        range_insert(pos, tmp.begin(), tmp.end(), forward_iterator_tag());
+    }
+}
+
+// 插入前向迭代器的区间：先求出元素个数n，在头尾时直接在预留的空间上构造，否则交给insert_aux
+template <class T, class Alloc, size_t BufSiz>
+template <class ForwardIterator>
+void deque<T, Alloc, BufSiz>::range_insert(iterator pos, ForwardIterator first,
+                                           ForwardIterator last, forward_iterator_tag) {
+    size_type n = distance(first, last);
+    if (n == 0)
+        return;
+    if (pos.cur == start.cur) {
+        iterator new_start = reserve_elements_at_front(n);
+        try {
+            Uninitialized_copy(first, last, new_start);
+            start = new_start;
+        }
+        catch(...) {
+            destroy_nodes_at_front(new_start);
+            throw;
+        }
+    }
+    else if (pos.cur == finish.cur) {
+        iterator new_finish = reserve_elements_at_back(n);
+        try {
+            Uninitialized_copy(first, last, finish);
+            finish = new_finish;
+        }
+        catch(...) {
+            destroy_nodes_at_back(new_finish);
+            throw;
+        }
+    }
+    else
+        insert_aux(pos, first, last, n);
+}
+
+template <class T, class Alloc, size_t BufSiz>
+void deque<T, Alloc, BufSiz>::insert_aux(iterator pos, size_type n, const value_type& x) {
+    const difference_type elems_before = pos - start;   // 插入点之前的元素个数
+    const size_type length = size();
+    value_type x_copy = x;      // x可能正是deque中的元素
+    if (elems_before < difference_type(length / 2)) {
+        // 插入点之前的元素比较少：在前端预留n个空间，把前段元素往前移
+        iterator new_start = reserve_elements_at_front(n);
+        iterator old_start = start;
+        pos = start + elems_before;     // 预留空间可能换了map，重新求出插入点
+        try {
+            if (elems_before >= difference_type(n)) {
+                iterator start_n = start + difference_type(n);
+                Uninitialized_copy(start, start_n, new_start);
+                start = new_start;
+                copy(start_n, pos, old_start);
+                fill(pos - difference_type(n), pos, x_copy);
+            }
+            else {
+                iterator mid = Uninitialized_copy(start, pos, new_start);
+                try {
+                    Uninitialized_fill(mid, start, x_copy);
+                }
+                catch(...) {
+                    Destroy(new_start, mid);
+                    throw;
+                }
+                start = new_start;
+                fill(old_start, pos, x_copy);
+            }
+        }
+        catch(...) {
+            destroy_nodes_at_front(new_start);
+            throw;
+        }
+    }
+    else {
+        // 插入点之后的元素比较少：在尾端预留n个空间，把后段元素往后移
+        iterator new_finish = reserve_elements_at_back(n);
+        iterator old_finish = finish;
+        const difference_type elems_after = difference_type(length) - elems_before;
+        pos = finish - elems_after;
+        try {
+            if (elems_after > difference_type(n)) {
+                iterator finish_n = finish - difference_type(n);
+                Uninitialized_copy(finish_n, finish, finish);
+                finish = new_finish;
+                copy_backward(pos, finish_n, old_finish);
+                fill(pos, pos + difference_type(n), x_copy);
+            }
+            else {
+                iterator mid = pos + difference_type(n);
+                Uninitialized_fill(finish, mid, x_copy);
+                try {
+                    Uninitialized_copy(pos, finish, mid);
+                }
+                catch(...) {
+                    Destroy(finish, mid);
+                    throw;
+                }
+                finish = new_finish;
+                fill(pos, old_finish, x_copy);
+            }
+        }
+        catch(...) {
+            destroy_nodes_at_back(new_finish);
+            throw;
+        }
+    }
+}
+
+template <class T, class Alloc, size_t BufSiz>
+template <class ForwardIterator>
+void deque<T, Alloc, BufSiz>::insert_aux(iterator pos, ForwardIterator first,
+                                         ForwardIterator last, size_type n) {
+    const difference_type elems_before = pos - start;
+    const size_type length = size();
+    if (elems_before < difference_type(length / 2)) {
+        iterator new_start = reserve_elements_at_front(n);
+        iterator old_start = start;
+        pos = start + elems_before;
+        try {
+            if (elems_before >= difference_type(n)) {
+                iterator start_n = start + difference_type(n);
+                Uninitialized_copy(start, start_n, new_start);
+                start = new_start;
+                copy(start_n, pos, old_start);
+                copy(first, last, pos - difference_type(n));
+            }
+            else {
+                // [first,last)的前n-elems_before个元素构造在新空间上，其余复制到原来的前段
+                ForwardIterator mid = first;
+                advance(mid, difference_type(n) - elems_before);
+                iterator mid_result = Uninitialized_copy(start, pos, new_start);
+                try {
+                    Uninitialized_copy(first, mid, mid_result);
+                }
+                catch(...) {
+                    Destroy(new_start, mid_result);
+                    throw;
+                }
+                start = new_start;
+                copy(mid, last, old_start);
+            }
+        }
+        catch(...) {
+            destroy_nodes_at_front(new_start);
+            throw;
+        }
+    }
+    else {
+        iterator new_finish = reserve_elements_at_back(n);
+        iterator old_finish = finish;
+        const difference_type elems_after = difference_type(length) - elems_before;
+        pos = finish - elems_after;
+        try {
+            if (elems_after > difference_type(n)) {
+                iterator finish_n = finish - difference_type(n);
+                Uninitialized_copy(finish_n, finish, finish);
+                finish = new_finish;
+                copy_backward(pos, finish_n, old_finish);
+                copy(first, last, pos);
+            }
+            else {
+                // [first,last)的后n-elems_after个元素构造在新空间上，其余复制到原来的后段
+                ForwardIterator mid = first;
+                advance(mid, elems_after);
+                iterator mid_result = Uninitialized_copy(mid, last, finish);
+                try {
+                    Uninitialized_copy(pos, finish, mid_result);
+                }
+                catch(...) {
+                    Destroy(finish, mid_result);
+                    throw;
+                }
+                finish = new_finish;
+                copy(first, mid, pos);
+            }
+        }
+        catch(...) {
+            destroy_nodes_at_back(new_finish);
+            throw;
+        }
+    }
+}
+
 // 重载==符号
-template <class T, size_t BufSiz>
-inline bool operator==(const deque<T, BufSiz>& x,const deque<T, BufSiz>& y) {
+template <class T, class Alloc, size_t BufSiz>
+inline bool operator==(const deque<T, Alloc, BufSiz>& x,const deque<T, Alloc, BufSiz>& y) {
   return x.size() == y.size() &&
          equal(x.begin(), x.end(), y.begin());
 }
 
 // 重载<符号
-template <class T, size_t BufSiz>
-inline bool operator<(const deque<T, BufSiz>& x,const deque<T, BufSiz>& y) {
+template <class T, class Alloc, size_t BufSiz>
+inline bool operator<(const deque<T, Alloc, BufSiz>& x,const deque<T, Alloc, BufSiz>& y) {
   return lexicographical_compare(x.begin(), x.end(), y.begin(), y.end());
 }
 
@@ -3,19 +3,20 @@
 
 #include <functional>
 #include "tiny_hashtable.h"
+#include "tiny_memory_resource.h"
 
-template <class Key, class T, class HashFcn = hash<Key>, class EqualKey = equal_to<Key>>
+template <class Key, class T, class HashFcn = hash<Key>, class EqualKey = equal_to<Key>, class Alloc = alloc>
 class hash_map;
 
-template <class Key, class T, class HashFcn, class EqualKey>
-inline bool operator==(const hash_map<Key, T, HashFcn, EqualKey> &,
-                       const hash_map<Key, T, HashFcn, EqualKey> &);
+template <class Key, class T, class HashFcn, class EqualKey, class Alloc>
+inline bool operator==(const hash_map<Key, T, HashFcn, EqualKey, Alloc> &,
+                       const hash_map<Key, T, HashFcn, EqualKey, Alloc> &);
 
-template <class Key, class T, class HashFcn, class EqualKey>
+template <class Key, class T, class HashFcn, class EqualKey, class Alloc>
 class hash_map
 {
     private:
-        typedef hashtable<pair<const Key,T>,Key,HashFcn,_Select1st<pair<const Key,T> >,EqualKey> ht;
+        typedef hashtable<pair<const Key,T>,Key,HashFcn,_Select1st<pair<const Key,T> >,EqualKey,Alloc> ht;
         ht rep;
 
     public:
@@ -25,6 +26,7 @@ class hash_map
         typedef typename ht::value_type value_type;
         typedef typename ht::hasher hasher;
         typedef typename ht::key_equal key_equal;
+        typedef typename ht::allocator_type allocator_type;
         
         typedef typename ht::size_type size_type;
         typedef typename ht::difference_type difference_type;
@@ -38,14 +40,16 @@ class hash_map
 
         hasher hash_funct() const { return rep.hash_funct(); }
         key_equal key_eq() const { return rep.key_eq(); }
+        allocator_type get_allocator() const { return rep.get_allocator(); }
 
     public:
         // 缺省使用大小为100的表格，将由hash table调整为最接近且较大之质数
         hash_map() : rep(100, hasher(), key_equal()) {}
         explicit hash_map(size_type n) : rep(n, hasher(), key_equal()) {}
         hash_map(size_type n, const hasher& hf) : rep(n, hf, key_equal()) {}
-        hash_map(size_type n, const hasher &hf, const key_equal &eql)
-            : rep(n, hf, eql) {}
+        hash_map(size_type n, const hasher &hf, const key_equal &eql,
+                 const allocator_type &a = allocator_type())
+            : rep(n, hf, eql, a) {}
 
         // 以下，插入操作全部使用insert_unique()，不允许键值重复
         template <class InputIterator>
@@ -113,25 +117,25 @@ class hash_map
             { return rep.elems_in_bucket(n); }
 };
 
-template <class Key, class T, class HashFcn, class EqualKey>
-inline bool operator==(const hash_map<Key, T, HashFcn, EqualKey> &hm1,
-                       const hash_map<Key, T, HashFcn, EqualKey> &hm2)
+template <class Key, class T, class HashFcn, class EqualKey, class Alloc>
+inline bool operator==(const hash_map<Key, T, HashFcn, EqualKey, Alloc> &hm1,
+                       const hash_map<Key, T, HashFcn, EqualKey, Alloc> &hm2)
 {
   return hm1.rep == hm2.rep;
 }
 
-template <class Key, class T, class HashFcn = hash<Key>, class EqualKey = equal_to<Key>>
+template <class Key, class T, class HashFcn = hash<Key>, class EqualKey = equal_to<Key>, class Alloc = alloc>
 class hash_multimap;
 
-template <class Key, class T, class HashFcn, class EqualKey>
-inline bool operator==(const hash_multimap<Key, T, HashFcn, EqualKey> & hm1,
-                       const hash_multimap<Key, T, HashFcn, EqualKey> & hm2);
+template <class Key, class T, class HashFcn, class EqualKey, class Alloc>
+inline bool operator==(const hash_multimap<Key, T, HashFcn, EqualKey, Alloc> & hm1,
+                       const hash_multimap<Key, T, HashFcn, EqualKey, Alloc> & hm2);
 
-template <class Key, class T, class HashFcn, class EqualKey>
+template <class Key, class T, class HashFcn, class EqualKey, class Alloc>
 class hash_multimap
 {
     private:
-        typedef hashtable<pair<const Key, T>, Key, HashFcn, _Select1st<pair<const Key, T>>, EqualKey> ht;
+        typedef hashtable<pair<const Key, T>, Key, HashFcn, _Select1st<pair<const Key, T>>, EqualKey, Alloc> ht;
         ht rep;
 
     public:
@@ -141,6 +145,7 @@ class hash_multimap
         typedef typename ht::value_type value_type;
         typedef typename ht::hasher hasher;
         typedef typename ht::key_equal key_equal;
+        typedef typename ht::allocator_type allocator_type;
 
         typedef typename ht::size_type size_type;
         typedef typename ht::difference_type difference_type;
@@ -154,13 +159,15 @@ class hash_multimap
 
         hasher hash_funct() const { return rep.hash_funct(); }
         key_equal key_eq() const { return rep.key_eq(); }
+        allocator_type get_allocator() const { return rep.get_allocator(); }
 
     public:
         hash_multimap() : rep(100, hasher(), key_equal()) {}
         explicit hash_multimap(size_type n) : rep(n, hasher(), key_equal()) {}
         hash_multimap(size_type n, const hasher& hf) : rep(n, hf, key_equal()) {}
-        hash_multimap(size_type n, const hasher& hf, const key_equal& eql)
-            : rep(n, hf, eql) {}
+        hash_multimap(size_type n, const hasher &hf, const key_equal &eql,
+                 const allocator_type &a = allocator_type())
+            : rep(n, hf, eql, a) {}
 
         template <class InputIterator>
         hash_multimap(InputIterator f, InputIterator l) : rep(100, hasher(), key_equal())
@@ -222,11 +229,15 @@ class hash_multimap
         { return rep.elems_in_bucket(n); }
 };
 
-template <class Key, class T, class HashFcn, class EqualKey>
-inline bool operator==(const hash_multimap<Key, T, HashFcn, EqualKey>& hm1,
-           const hash_multimap<Key, T, HashFcn, EqualKey>& hm2)
+template <class Key, class T, class HashFcn, class EqualKey, class Alloc>
+inline bool operator==(const hash_multimap<Key, T, HashFcn, EqualKey, Alloc>& hm1,
+           const hash_multimap<Key, T, HashFcn, EqualKey, Alloc>& hm2)
 {
   return hm1.rep == hm2.rep;
 }
 
-#endif
\ No newline at end of file
+// 以memory_resource配置空间的hash_map，资源可在运行期选择
+template <class Key, class T, class HashFcn = hash<Key>, class EqualKey = equal_to<Key>>
+using pmr_hash_map = hash_map<Key, T, HashFcn, EqualKey, polymorphic_alloc>;
+
+#endif
@@ -4,20 +4,20 @@
 #include <functional>
 #include "tiny_hashtable.h"
 
-template <class Value, class HashFcn = hash<Value>, class EqualKey = equal_to<Value>>
+template <class Value, class HashFcn = hash<Value>, class EqualKey = equal_to<Value>, class Alloc = alloc>
 class hash_set;
 
-template <class Value, class HashFcn, class EqualKey>
+template <class Value, class HashFcn, class EqualKey, class Alloc>
 inline bool 
-operator==(const hash_set<Value,HashFcn,EqualKey>& hs1,
-           const hash_set<Value,HashFcn,EqualKey>& hs2) {
+operator==(const hash_set<Value, HashFcn, EqualKey, Alloc>& hs1,
+           const hash_set<Value, HashFcn, EqualKey, Alloc>& hs2) {
     return hs1.rep == hs2.rep;
 }
 
-template <class Value, class HashFcn, class EqualKey>
+template <class Value, class HashFcn, class EqualKey, class Alloc>
 class hash_set {
     private:
-        typedef hashtable<Value, Value, HashFcn, _Identity<Value>, EqualKey> ht;
+        typedef hashtable<Value, Value, HashFcn, _Identity<Value>, EqualKey, Alloc> ht;
 
         ht rep;     // 底层机制以hash table完成
     public:
@@ -25,6 +25,7 @@ class hash_set {
         typedef typename ht::value_type value_type;
         typedef typename ht::hasher hasher;
         typedef typename ht::key_equal key_equal;
+        typedef typename ht::allocator_type allocator_type;
 
         typedef typename ht::size_type size_type;
         typedef typename ht::difference_type difference_type;
@@ -38,14 +39,16 @@ class hash_set {
 
         hasher hash_funct() const { return rep.hash_funct(); }
         key_equal key_eq() const { return rep.key_eq(); }
+        allocator_type get_allocator() const { return rep.get_allocator(); }
 
     public:
         // 缺省使用大小为100的表格，将被hash table调整为最接近且较大之质数
         hash_set() : rep(100, hasher(), key_equal()) {}
         explicit hash_set(size_type n) : rep(n, hasher(), key_equal()) {}
         hash_set(size_type n, const hasher &hf) : rep(n, hf, key_equal()) {}
-        hash_set(size_type n, const hasher &hf, const key_equal &eql)
-            : rep(n, hf, eql) {}
+        hash_set(size_type n, const hasher &hf, const key_equal &eql,
+                 const allocator_type &a = allocator_type())
+            : rep(n, hf, eql, a) {}
 
         // 以下，插入操作全部使用insert_unique()，不允许键值重复
         template <class InputIterator>
@@ -106,24 +109,25 @@ class hash_set {
         
 };
 
-template <class Value, class HashFcn = hash<Value>, class EqualKey = equal_to<Value>>
+template <class Value, class HashFcn = hash<Value>, class EqualKey = equal_to<Value>, class Alloc = alloc>
 class hash_multiset;
 
-template <class Value, class HashFcn, class EqualKey>
+template <class Value, class HashFcn, class EqualKey, class Alloc>
 inline bool 
-operator==(const hash_multiset<Value,HashFcn,EqualKey>& hs1,
-           const hash_multiset<Value,HashFcn,EqualKey>& hs2);
+operator==(const hash_multiset<Value, HashFcn, EqualKey, Alloc>& hs1,
+           const hash_multiset<Value, HashFcn, EqualKey, Alloc>& hs2);
 
-template <class Value, class HashFcn, class EqualKey>
+template <class Value, class HashFcn, class EqualKey, class Alloc>
 class hash_multiset {
     private:
-        typedef hashtable<Value, Value, HashFcn, _Identity<Value>, EqualKey> ht;
+        typedef hashtable<Value, Value, HashFcn, _Identity<Value>, EqualKey, Alloc> ht;
         ht rep;
     public:
         typedef typename ht::key_type key_type;
         typedef typename ht::value_type value_type;
         typedef typename ht::hasher hasher;
         typedef typename ht::key_equal key_equal;
+        typedef typename ht::allocator_type allocator_type;
 
         typedef typename ht::size_type size_type;
         typedef typename ht::difference_type difference_type;
@@ -137,14 +141,16 @@ class hash_multiset {
 
         hasher hash_funct() const { return rep.hash_funct(); }
         key_equal key_eq() const { return rep.key_eq(); }
+        allocator_type get_allocator() const { return rep.get_allocator(); }
 
     public:
         // 缺省使用大小为100的表格，将hash table调整为最接近且较大之质数
         hash_multiset() : rep(100, hasher(), key_equal()) {}
         explicit hash_multiset(size_type n) : rep(n, hasher(), key_equal()) {}
         hash_multiset(size_type n, const hasher& hf) : rep(n, hf, key_equal()) {}
-        hash_multiset(size_type n, const hasher& hf, const key_equal& eql)
-            : rep(n, hf, eql) {}
+        hash_multiset(size_type n, const hasher &hf, const key_equal &eql,
+                 const allocator_type &a = allocator_type())
+            : rep(n, hf, eql, a) {}
 
     // 以下，插入操作全部使用insert_equal()，允许键值重复
         template <class InputIterator>
@@ -198,10 +204,10 @@ class hash_multiset {
             { return rep.elems_in_bucket(n); }
 };
 
-template <class Value, class HashFcn, class EqualKey>
+template <class Value, class HashFcn, class EqualKey, class Alloc>
 inline bool 
-operator==(const hash_multiset<Value,HashFcn,EqualKey>& hs1,
-           const hash_multiset<Value,HashFcn,EqualKey>& hs2)
+operator==(const hash_multiset<Value, HashFcn, EqualKey, Alloc>& hs1,
+           const hash_multiset<Value, HashFcn, EqualKey, Alloc>& hs2)
 {
   return hs1.ht == hs2.ht;
 }
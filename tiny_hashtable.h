@@ -14,16 +14,16 @@ struct __hashtable_node
     Value val;
 };
 
-template <class Value, class Key, class HashFcn, class ExtractKey, class EqualKey>
+template <class Value, class Key, class HashFcn, class ExtractKey, class EqualKey, class Alloc = alloc>
 class hashtable;
 
-template <class Value, class Key, class HashFcn, class ExtractKey, class EqualKey>
+template <class Value, class Key, class HashFcn, class ExtractKey, class EqualKey, class Alloc>
 struct __hashtable_iterator;
 
-template <class Value, class Key, class HashFcn, class ExtractKey, class EqualKey>
+template <class Value, class Key, class HashFcn, class ExtractKey, class EqualKey, class Alloc>
 struct __hashtable_const_iterator;
 
-template <class Value, class Key, class HashFcn, class ExtractKey, class EqualKey>
+template <class Value, class Key, class HashFcn, class ExtractKey, class EqualKey, class Alloc>
 struct __hashtable_iterator {
     typedef forward_iterator_tag iterator_category;
     typedef Value value_type;
@@ -32,9 +32,9 @@ struct __hashtable_iterator {
     typedef Value &reference;
     typedef Value pointer;
 
-    typedef hashtable<Value, Key, HashFcn, ExtractKey, EqualKey> hashtable;
-    typedef __hashtable_iterator<Value, Key, HashFcn, ExtractKey, EqualKey> iterator;
-    typedef __hashtable_const_iterator<Value, Key, HashFcn, ExtractKey, EqualKey> const_iterator;
+    typedef hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc> hashtable;
+    typedef __hashtable_iterator<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc> iterator;
+    typedef __hashtable_const_iterator<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc> const_iterator;
     typedef __hashtable_node<Value> node;
 
     node *cur;      // 迭代器目前所指之节点
@@ -50,11 +50,11 @@ struct __hashtable_iterator {
     bool operator!=(const iterator &it) const { return cur != it.cur; }
 };
 
-template <class Value, class Key, class HashFcn, class ExtractKey, class EqualKey>
+template <class Value, class Key, class HashFcn, class ExtractKey, class EqualKey, class Alloc>
 struct __hashtable_const_iterator {
-    typedef hashtable<Value, Key, HashFcn, ExtractKey, EqualKey> hashtable;
-    typedef __hashtable_iterator<Value, Key, HashFcn, ExtractKey, EqualKey> iterator;
-    typedef __hashtable_const_iterator<Value, Key, HashFcn, ExtractKey, EqualKey> const_iterator;
+    typedef hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc> hashtable;
+    typedef __hashtable_iterator<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc> iterator;
+    typedef __hashtable_const_iterator<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc> const_iterator;
     typedef __hashtable_node<Value> node;
 
     typedef forward_iterator_tag iterator_category;
@@ -90,9 +90,9 @@ static const unsigned long __stl_prime_list[__stl_num_primes] =
     1610612741ul, 3221225473ul, 4294967291ul
 };
 
-template <class Value, class Key, class HashFcn, class ExtractKey, class EqualKey>
-bool operator==(const hashtable<Value, Key, HashFcn, ExtractKey, EqualKey> &ht1,
-                const hashtable<Value, Key, HashFcn, ExtractKey, EqualKey> &ht2);
+template <class Value, class Key, class HashFcn, class ExtractKey, class EqualKey, class Alloc>
+bool operator==(const hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc> &ht1,
+                const hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc> &ht2);
 
 // 以下找出上述28个质数之中，最接近并大于或等于n的那个质数
 inline unsigned long __stl_next_prime(unsigned long n)
@@ -105,8 +105,8 @@ inline unsigned long __stl_next_prime(unsigned long n)
     return pos == last ? *(last - 1) : *pos;
 }
 
-template <class Value, class Key, class HashFcn, class ExtractKey, class EqualKey>
-class hashtable {
+template <class Value, class Key, class HashFcn, class ExtractKey, class EqualKey, class Alloc>
+class hashtable : protected simple_alloc<__hashtable_node<Value>, Alloc> {
     public:
         // 为template型别参数重新定义一个名称
         typedef Value value_type;
@@ -120,6 +120,7 @@ class hashtable {
         typedef const value_type* const_pointer;
         typedef value_type&       reference;
         typedef const value_type& const_reference;
+        typedef Alloc allocator_type;
 
         hasher hash_funct() const { return hash; }
         key_equal key_eq() const { return equals; }
@@ -130,24 +131,25 @@ class hashtable {
         ExtractKey get_key;
 
         typedef __hashtable_node<Value> node;
-        typedef simple_alloc<node> node_allocator;
+        // hashtable继承节点配置器以保存Alloc，buckets vector另持一份
+        typedef simple_alloc<node, Alloc> node_allocator;
 
-        __TINY_VECTOR_H::vector<node *> buckets;
+        __TINY_VECTOR_H::vector<node *, Alloc> buckets;
         size_type num_elements;
         // 构造结点
         node* get_node() { return node_allocator::allocate(1); }
         // 析构结点
         void put_node(node* p) { node_allocator::deallocate(p, 1); }
     public:
-        typedef __hashtable_iterator<Value, Key, HashFcn, ExtractKey, EqualKey>
+        typedef __hashtable_iterator<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc>
                 iterator;
-        typedef __hashtable_const_iterator<Value, Key, HashFcn, ExtractKey, EqualKey> 
+        typedef __hashtable_const_iterator<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc> 
                 const_iterator;
 
         friend struct
-        __hashtable_iterator<Value, Key, HashFcn, ExtractKey, EqualKey>;
+        __hashtable_iterator<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc>;
         friend struct
-        __hashtable_const_iterator<Value, Key, HashFcn, ExtractKey, EqualKey>;
+        __hashtable_const_iterator<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc>;
 
         friend bool operator== <>(const hashtable &, const hashtable &);
 
@@ -203,24 +205,32 @@ class hashtable {
 
     public:
         // 初始化构造函数
-        hashtable(size_type n, const HashFcn &hf, const EqualKey &eql)
-            : hash(hf), equals(eql), get_key(ExtractKey()), num_elements(0) {
+        hashtable(size_type n, const HashFcn &hf, const EqualKey &eql,
+                  const allocator_type &a = allocator_type())
+            : node_allocator(a), hash(hf), equals(eql), get_key(ExtractKey()),
+              buckets(a), num_elements(0) {
             initializer_buckets(n);
         }
 
         // 拷贝构造函数
-        hashtable(const hashtable &ht) : hash(ht.hash), equals(ht.equals),
-                                         get_key(ht.get_key), num_elements(0) {
+        hashtable(const hashtable &ht) : node_allocator(ht.get_allocator()),
+                                         hash(ht.hash), equals(ht.equals),
+                                         get_key(ht.get_key), buckets(ht.get_allocator()),
+                                         num_elements(0) {
             copy_from(ht);
         }
 
         // 构造函数
         hashtable(size_type n, const HashFcn &hf,
-                  const EqualKey &eql, const ExtractKey &ext)
-            : hash(hf), equals(eql), get_key(ext), num_elements(0) {
+                  const EqualKey &eql, const ExtractKey &ext,
+                  const allocator_type &a = allocator_type())
+            : node_allocator(a), hash(hf), equals(eql), get_key(ext),
+              buckets(a), num_elements(0) {
             initializer_buckets(n);
         }
 
+        allocator_type get_allocator() const { return node_allocator::get_allocator(); }
+
         hashtable& operator= (const hashtable& ht) {
             if (&ht != this) {
                 clear();
@@ -237,8 +247,11 @@ class hashtable {
         size_type size() const { return num_elements; }
         size_type max_size() const { return size_type(-1); }
         bool empty() const { return size() == 0; }
+        void clear();
 
+        // 配置器随节点一起交换，buckets vector的配置器由vector::swap负责
         void swap(hashtable& ht) {
+            std::swap((node_allocator&)*this, (node_allocator&)ht);
             std::swap(hash, ht.hash);
             std::swap(equals, ht.equals);
             std::swap(get_key, ht.get_key);
@@ -265,8 +278,6 @@ class hashtable {
         const_iterator end() const { return const_iterator(0, this); }
 
     private:
-        void clear();
-
         // 拷贝函数
         void copy_from(const hashtable &ht);
         // 初始化buckets
@@ -277,10 +288,10 @@ class hashtable {
             num_elements = 0;
         }
         // 在不需要重建表格的情况下插入新节点，键值不允许重复
-        pair<typename hashtable<Value, Key, HashFcn, ExtractKey, EqualKey>::iterator, bool>
+        pair<typename hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc>::iterator, bool>
         insert_unique_noresize(const value_type& obj);
 
-        typename hashtable<Value, Key, HashFcn, ExtractKey, EqualKey>::iterator
+        typename hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc>::iterator
         insert_equal_noresize(const value_type& obj);
 
         void erase_bucket(const size_type n, node *first, node *last);
@@ -375,9 +386,9 @@ class hashtable {
         void erase(const_iterator first, const_iterator last);
 };
 
-template <class Value, class Key, class HashFcn, class ExtractKey, class EqualKey>
-__hashtable_iterator<Value, Key, HashFcn, ExtractKey, EqualKey> &
-__hashtable_iterator<Value, Key, HashFcn, ExtractKey, EqualKey>::operator++() {
+template <class Value, class Key, class HashFcn, class ExtractKey, class EqualKey, class Alloc>
+__hashtable_iterator<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc> &
+__hashtable_iterator<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc>::operator++() {
     const node *old = cur;
     cur = cur->next;        // 如果存在，就是它，否则就进入以下if流程
     if(!cur) {
@@ -389,17 +400,17 @@ __hashtable_iterator<Value, Key, HashFcn, ExtractKey, EqualKey>::operator++() {
     return *this;
 }
 
-template <class Value, class Key, class HashFcn, class ExtractKey, class EqualKey>
-inline __hashtable_iterator<Value, Key, HashFcn, ExtractKey, EqualKey>
-__hashtable_iterator<Value, Key, HashFcn, ExtractKey, EqualKey>::operator++(int) {
+template <class Value, class Key, class HashFcn, class ExtractKey, class EqualKey, class Alloc>
+inline __hashtable_iterator<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc>
+__hashtable_iterator<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc>::operator++(int) {
     iterator tmp = *this;
     ++*this;        // 调用operator++()
     return tmp;
 }
 
-template <class Value, class Key, class HashFcn, class ExtractKey, class EqualKey>
-__hashtable_const_iterator<Value, Key, HashFcn, ExtractKey, EqualKey> &
-__hashtable_const_iterator<Value, Key, HashFcn, ExtractKey, EqualKey>::operator++()
+template <class Value, class Key, class HashFcn, class ExtractKey, class EqualKey, class Alloc>
+__hashtable_const_iterator<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc> &
+__hashtable_const_iterator<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc>::operator++()
 {
     const node *old = cur;
     cur = cur->next;        // 如果存在，就是它，否则就进入以下if流程
@@ -412,19 +423,19 @@ __hashtable_const_iterator<Value, Key, HashFcn, ExtractKey, EqualKey>::operator+
     return *this;
 }
 
-template <class Value, class Key, class HashFcn, class ExtractKey, class EqualKey>
-inline __hashtable_const_iterator<Value, Key, HashFcn, ExtractKey, EqualKey>
-__hashtable_const_iterator<Value, Key, HashFcn, ExtractKey, EqualKey>::operator++(int) {
+template <class Value, class Key, class HashFcn, class ExtractKey, class EqualKey, class Alloc>
+inline __hashtable_const_iterator<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc>
+__hashtable_const_iterator<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc>::operator++(int) {
     iterator tmp = *this;
     ++*this;        // 调用operator++()
     return tmp;
 }
 
-template <class Value, class Key, class HashFcn, class ExtractKey, class EqualKey>
-bool operator==(const hashtable<Value, Key, HashFcn, ExtractKey, EqualKey>& ht1,
-                const hashtable<Value, Key, HashFcn, ExtractKey, EqualKey>& ht2)
+template <class Value, class Key, class HashFcn, class ExtractKey, class EqualKey, class Alloc>
+bool operator==(const hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc>& ht1,
+                const hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc>& ht2)
 {
-    typedef typename hashtable<Value, Key, HashFcn, ExtractKey, EqualKey>::node node;
+    typedef typename hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc>::node node;
     if (ht1.buckets.size() != ht2.buckets.size())
         return false;
     for (int n = 0; n < ht1.buckets.size(); ++n) {
@@ -440,14 +451,14 @@ bool operator==(const hashtable<Value, Key, HashFcn, ExtractKey, EqualKey>& ht1,
 }
 
 // 以下函数判断是否需要重建表格，如果不需要，立即回返
-template <class Value, class Key, class HashFcn, class ExtractKey, class EqualKey>
-void hashtable<Value, Key, HashFcn, ExtractKey, EqualKey>::resize(size_type num_elements_hint)
+template <class Value, class Key, class HashFcn, class ExtractKey, class EqualKey, class Alloc>
+void hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc>::resize(size_type num_elements_hint)
 {
   const size_type old_n = buckets.size();
     if (num_elements_hint > old_n) {        // 确定真的需要重新配置
         const size_type n = next_size(num_elements_hint);   // 找出下一个质数
         if (n > old_n) {
-            __TINY_VECTOR_H::vector<node *> tmp(n, (node *)0);       // 设立新的buckets
+            __TINY_VECTOR_H::vector<node *, Alloc> tmp(n, (node *)0, get_allocator());   // 设立新的buckets
             try {
                 // 以下处理每一个旧的buckets
                 for (size_type bucket = 0; bucket < old_n; ++bucket) {
@@ -481,9 +492,9 @@ void hashtable<Value, Key, HashFcn, ExtractKey, EqualKey>::resize(size_type num_
     }
 }
 
-template <class Value, class Key, class HashFcn, class ExtractKey, class EqualKey>
-pair<typename hashtable<Value, Key, HashFcn, ExtractKey, EqualKey>::iterator,bool>
-hashtable<Value, Key, HashFcn, ExtractKey, EqualKey>::insert_unique_noresize(const value_type& obj) {
+template <class Value, class Key, class HashFcn, class ExtractKey, class EqualKey, class Alloc>
+pair<typename hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc>::iterator,bool>
+hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc>::insert_unique_noresize(const value_type& obj) {
     const size_type n = bkt_num(obj);
     node* first = buckets[n];
 
@@ -498,9 +509,9 @@ hashtable<Value, Key, HashFcn, ExtractKey, EqualKey>::insert_unique_noresize(con
     return pair<iterator, bool>(iterator(tmp, this), true);
 }
 
-template <class Value, class Key, class HashFcn, class ExtractKey, class EqualKey>
-typename hashtable<Value, Key, HashFcn, ExtractKey, EqualKey>::iterator 
-hashtable<Value, Key, HashFcn, ExtractKey, EqualKey>::insert_equal_noresize(const value_type& obj)
+template <class Value, class Key, class HashFcn, class ExtractKey, class EqualKey, class Alloc>
+typename hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc>::iterator 
+hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc>::insert_equal_noresize(const value_type& obj)
 {
     const size_type n = bkt_num(obj);
     node* first = buckets[n];
@@ -523,16 +534,23 @@ hashtable<Value, Key, HashFcn, ExtractKey, EqualKey>::insert_equal_noresize(cons
     return iterator(tmp, this);
 }
 
-template <class Value, class Key, class HashFcn, class ExtractKey, class EqualKey>
-void hashtable<Value, Key, HashFcn, ExtractKey, EqualKey>::clear()
+template <class Value, class Key, class HashFcn, class ExtractKey, class EqualKey, class Alloc>
+void hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc>::clear()
 {
+    // 配置器的释放为空操作(如monotonic_buffer_resource)时不必逐一归还节点
+    // 若元素又无需析构，就不必走访bucket list，只需清空buckets
+    bool release = !node_allocator::deallocate_is_noop();
+    bool walk = release || !__type_traits<Value>::has_trivial_destructor::value;
     // 针对每一个bucket
     for (size_type i = 0; i < buckets.size(); ++i) {
         node* cur = buckets[i];
         // 将bucket list中的每一个节点删除掉
-        while (cur != 0) {
+        while (walk && cur != 0) {
             node* next = cur->next;
-            delete_node(cur);
+            if (release)
+                delete_node(cur);
+            else
+                Destroy(&cur->val);
             cur = next;
         }
         buckets[i] = 0;     // 令bucket内容为null指针
@@ -541,8 +559,8 @@ void hashtable<Value, Key, HashFcn, ExtractKey, EqualKey>::clear()
     // 注意，buckets vector并未释放掉空间，仍保有原来大小
 }
 
-template <class Value, class Key, class HashFcn, class ExtractKey, class EqualKey>
-void hashtable<Value, Key, HashFcn, ExtractKey, EqualKey>::copy_from(const hashtable& ht)
+template <class Value, class Key, class HashFcn, class ExtractKey, class EqualKey, class Alloc>
+void hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc>::copy_from(const hashtable& ht)
 {
     // 先清除已方的buckets vector，这操作是调用vector::clear，将整个容器清空
     buckets.clear();
@@ -576,10 +594,10 @@ void hashtable<Value, Key, HashFcn, ExtractKey, EqualKey>::copy_from(const hasht
     }
 }
 
-template <class Value, class Key, class HashFcn, class ExtractKey, class EqualKey>
-pair<typename hashtable<Value, Key, HashFcn, ExtractKey, EqualKey>::iterator,
-     typename hashtable<Value, Key, HashFcn, ExtractKey, EqualKey>::iterator> 
-hashtable<Value, Key, HashFcn, ExtractKey, EqualKey>::equal_range(const key_type& key)
+template <class Value, class Key, class HashFcn, class ExtractKey, class EqualKey, class Alloc>
+pair<typename hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc>::iterator,
+     typename hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc>::iterator> 
+hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc>::equal_range(const key_type& key)
 {
     typedef pair<iterator, iterator> Pii;
     const size_type n = bkt_num_key(key);
@@ -598,10 +616,10 @@ hashtable<Value, Key, HashFcn, ExtractKey, EqualKey>::equal_range(const key_type
     return Pii(end(), end());
 }
 
-template <class Value, class Key, class HashFcn, class ExtractKey, class EqualKey>
-pair<typename hashtable<Value, Key, HashFcn, ExtractKey, EqualKey>::const_iterator, 
-     typename hashtable<Value, Key, HashFcn, ExtractKey, EqualKey>::const_iterator> 
-hashtable<Value, Key, HashFcn, ExtractKey, EqualKey>::equal_range(const key_type& key) const
+template <class Value, class Key, class HashFcn, class ExtractKey, class EqualKey, class Alloc>
+pair<typename hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc>::const_iterator, 
+     typename hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc>::const_iterator> 
+hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc>::equal_range(const key_type& key) const
 {
     typedef pair<const_iterator, const_iterator> Pii;
     const size_type n = bkt_num_key(key);
@@ -626,9 +644,9 @@ hashtable<Value, Key, HashFcn, ExtractKey, EqualKey>::equal_range(const key_type
     return Pii(end(), end());
 }
 
-template <class Value, class Key, class HashFcn, class ExtractKey, class EqualKey>
-typename hashtable<Value, Key, HashFcn, ExtractKey, EqualKey>::size_type 
-hashtable<Value, Key, HashFcn, ExtractKey, EqualKey>::erase(const key_type& key)
+template <class Value, class Key, class HashFcn, class ExtractKey, class EqualKey, class Alloc>
+typename hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc>::size_type 
+hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc>::erase(const key_type& key)
 {
     const size_type n = bkt_num_key(key);
     node* first = buckets[n];
@@ -660,8 +678,8 @@ hashtable<Value, Key, HashFcn, ExtractKey, EqualKey>::erase(const key_type& key)
     return erased;
 }
 
-template <class Value, class Key, class HashFcn, class ExtractKey, class EqualKey>
-void hashtable<Value, Key, HashFcn, ExtractKey, EqualKey>::erase(const iterator& it)
+template <class Value, class Key, class HashFcn, class ExtractKey, class EqualKey, class Alloc>
+void hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc>::erase(const iterator& it)
 {
     node* p = it.cur;
     if (p) {
@@ -691,8 +709,8 @@ void hashtable<Value, Key, HashFcn, ExtractKey, EqualKey>::erase(const iterator&
     }
 }
 
-template <class Value, class Key, class HashFcn, class ExtractKey, class EqualKey>
-void hashtable<Value, Key, HashFcn, ExtractKey, EqualKey>
+template <class Value, class Key, class HashFcn, class ExtractKey, class EqualKey, class Alloc>
+void hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc>
   ::erase(iterator first, iterator last)
 {
     size_type __f_bucket = first.cur ? 
@@ -713,9 +731,9 @@ void hashtable<Value, Key, HashFcn, ExtractKey, EqualKey>
     }
 }
 
-template <class Value, class Key, class HashFcn, class ExtractKey, class EqualKey>
+template <class Value, class Key, class HashFcn, class ExtractKey, class EqualKey, class Alloc>
 inline void
-hashtable<Value, Key, HashFcn, ExtractKey, EqualKey>::erase(const_iterator first,
+hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc>::erase(const_iterator first,
                                              const_iterator last)
 {
     erase(iterator(const_cast<node*>(first.cur),
@@ -724,17 +742,17 @@ hashtable<Value, Key, HashFcn, ExtractKey, EqualKey>::erase(const_iterator first
                     const_cast<hashtable*>(last.ht)));
 }
 
-template <class Value, class Key, class HashFcn, class ExtractKey, class EqualKey>
+template <class Value, class Key, class HashFcn, class ExtractKey, class EqualKey, class Alloc>
 inline void
-hashtable<Value, Key, HashFcn, ExtractKey, EqualKey>::erase(const const_iterator& it)
+hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc>::erase(const const_iterator& it)
 {
     erase(iterator(const_cast<node*>(it.cur),
                     const_cast<hashtable*>(it.ht)));
 }
 
 
-template <class Value, class Key, class HashFcn, class ExtractKey, class EqualKey>
-void hashtable<Value, Key, HashFcn, ExtractKey, EqualKey>
+template <class Value, class Key, class HashFcn, class ExtractKey, class EqualKey, class Alloc>
+void hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc>
   ::erase_bucket(const size_type n, node* first, node* last)
 {
     node* cur = buckets[n];
@@ -755,8 +773,8 @@ void hashtable<Value, Key, HashFcn, ExtractKey, EqualKey>
     }
 }
 
-template <class Value, class Key, class HashFcn, class ExtractKey, class EqualKey>
-void hashtable<Value, Key, HashFcn, ExtractKey, EqualKey>
+template <class Value, class Key, class HashFcn, class ExtractKey, class EqualKey, class Alloc>
+void hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc>
   ::erase_bucket(const size_type n, node* last)
 {
     node* cur = buckets[n];
@@ -769,9 +787,9 @@ void hashtable<Value, Key, HashFcn, ExtractKey, EqualKey>
     }
 }
 
-template <class Value, class Key, class HashFcn, class ExtractKey, class EqualKey>
-typename hashtable<Value, Key, HashFcn, ExtractKey, EqualKey>::reference 
-hashtable<Value, Key, HashFcn, ExtractKey, EqualKey>::find_or_insert(const value_type& obj)
+template <class Value, class Key, class HashFcn, class ExtractKey, class EqualKey, class Alloc>
+typename hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc>::reference 
+hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc>::find_or_insert(const value_type& obj)
 {
     resize(num_elements + 1);
 
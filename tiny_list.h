@@ -4,6 +4,7 @@
 #include <iterator>
 #include "tiny_construct.h"
 #include "tiny_alloc.h"
+#include "tiny_memory_resource.h"
 #include <algorithm>
 
 // 节点定义
@@ -67,12 +68,12 @@ struct __list_iterator {
     }
 };
 
-template <class T>
-class list {
+template <class T, class Alloc = alloc>
+class list : protected simple_alloc<__list_node<T>, Alloc> {
     protected:
         typedef __list_node<T> list_node;
-        // 专属空间配置器，每次配置一个节点大小
-        typedef simple_alloc<list_node> list_node_allocator;
+        // 专属空间配置器，每次配置一个节点大小，list继承它以保存Alloc
+        typedef simple_alloc<list_node, Alloc> list_node_allocator;
 
     public:
         typedef T value_type;
@@ -84,6 +85,7 @@ class list {
         typedef size_t size_type;
         typedef __list_node<T> Node;
         typedef ptrdiff_t difference_type;
+        typedef Alloc allocator_type;
         // 迭代器指针
         typedef __list_iterator<T, T &, T *> iterator;
         typedef __list_iterator<T, const T &, const T *> const_iterator;
@@ -129,6 +131,28 @@ class list {
     public:
         // 默认构造函数
         explicit list() { empty_initialize(); }
+        explicit list(const allocator_type& a) : list_node_allocator(a) { empty_initialize(); }
+        // 拷贝构造函数，配置器随之复制
+        list(const list<T, Alloc>& x) : list_node_allocator(x) {
+            empty_initialize();
+            for (const_iterator i = x.begin(); i != x.end(); ++i)
+                push_back(*i);
+        }
+        // 析构函数，销毁所有节点并归还头节点
+        ~list() {
+            clear();
+            put_node(node);
+        }
+
+        list<T, Alloc>& operator=(const list<T, Alloc>& x) {
+            if (this != &x) {
+                list<T, Alloc> tmp(x);
+                swap(tmp);
+            }
+            return *this;
+        }
+
+        allocator_type get_allocator() const { return list_node_allocator::get_allocator(); }
 
         iterator begin() { return (link_type)(node->next); }
         const_iterator begin() const { return (link_type)(node->next); }
@@ -162,8 +186,11 @@ class list {
         reference back() { return *(--end()); }
         const_reference back() const { return *(--end()); }
 
-        // algorithm算法的swap函数
-        void swap(list<T>& x) { std::swap(node, x.node); }
+        // algorithm算法的swap函数，配置器随节点一起交换
+        void swap(list<T, Alloc>& x) {
+            std::swap((list_node_allocator&)*this, (list_node_allocator&)x);
+            std::swap(node, x.node);
+        }
 
         // 插入一个节点，作为尾节点
         void push_back(const T &x) { insert(end(), x); }
@@ -228,7 +255,7 @@ class list {
                 transfer(position, first, last);
         }
         // merge()将x合并到*this身上,两个lists的内容都必须先经过递增排序
-        void merge(list<T> &x);
+        void merge(list<T, Alloc> &x);
         // reverse()将*this的内容逆向重置
         void reverse();
         // list自己的排序算法
@@ -236,8 +263,8 @@ class list {
 };
 
 // 清除所有节点（整个链表）
-template<class T>
-void list<T>::clear()
+template <class T, class Alloc>
+void list<T, Alloc>::clear()
 {
     link_type cur = (link_type)node->next;  // begin()
     while (cur != node) {       // 遍历每一个节点
@@ -251,8 +278,8 @@ void list<T>::clear()
 }
 
 // 将数值为value之所有元素移除
-template<class T>
-void list<T>::remove(const T &value) {
+template <class T, class Alloc>
+void list<T, Alloc>::remove(const T &value) {
     iterator first = begin();
     iterator last = end();
     while (first != last) {     // 遍历每一个节点
@@ -265,8 +292,8 @@ void list<T>::remove(const T &value) {
 }
 
 // 移除数值相同的连续元素，只有连续相同的元素，才会被移除剩一个
-template<class T>
-void list<T>::unique() {
+template <class T, class Alloc>
+void list<T, Alloc>::unique() {
     iterator first = begin();
     iterator last = end();
     if(first == last)   // 空链表，什么都不做
@@ -281,8 +308,8 @@ void list<T>::unique() {
     }
 }
 // 两个链表合并
-template<class T>
-void list<T>::merge(list<T>& x) {
+template <class T, class Alloc>
+void list<T, Alloc>::merge(list<T, Alloc>& x) {
     iterator first1 = begin();
     iterator last1 = end();
     iterator first2 = x.begin();
@@ -302,8 +329,8 @@ void list<T>::merge(list<T>& x) {
 }
 
 // reverse()将*this的内容逆向重置
-template<class T>
-void list<T>::reverse() {
+template <class T, class Alloc>
+void list<T, Alloc>::reverse() {
     // 以下判断，如果有空链表，或仅有一个元素，就不进行任何操作
     // 使用size()==0||size()==1来判断，虽然可以，但是比较慢
     if(node->next == node || link_type(node->next)->next == node)
@@ -319,30 +346,48 @@ void list<T>::reverse() {
 
 // STL算法sort()只接受RandomAccessIterator
 // 本函数采用quick sort
-template <class T>
-void list<T>::sort() {
+template <class T, class Alloc>
+void list<T, Alloc>::sort() {
     // 以下判断，如果有空链表，或仅有一个元素，就不进行任何操作
     // 使用size()==0||size()==1来判断，虽然可以，但是比较慢
     if(node->next == node || link_type(node->next)->next == node)
         return;
     // 一些新的lists，作为中介数据存放区
-    list<T> carry;
-    list<T> counter[64];
+    // 它们与*this使用同一配置器，节点在其间搬动、比较抛出异常时也由它们归还
+    // counter[i]在第一次用到时才构造，只需log(n)个哨兵节点
+    allocator_type a = get_allocator();
+    list<T, Alloc> carry(a);
+    alignas(list<T, Alloc>) unsigned char counter_buf[sizeof(list<T, Alloc>) * 64];
+    list<T, Alloc>* counter = reinterpret_cast<list<T, Alloc>*>(counter_buf);
     int fill = 0;
-    while(!empty()) {
-        carry.splice(carry.begin(), *this, begin());
-        int i = 0;
-        while(i < fill && !counter[i].empty()) {
-            counter[i].merge(carry);
-            carry.swap(counter[i++]);
+    try {
+        while(!empty()) {
+            carry.splice(carry.begin(), *this, begin());
+            int i = 0;
+            while(i < fill && !counter[i].empty()) {
+                counter[i].merge(carry);
+                carry.swap(counter[i++]);
+            }
+            if (i == fill) {
+                Construct(counter + fill, a);
+                ++fill;
+            }
+            carry.swap(counter[i]);
         }
-        carry.swap(counter[i]);
-        if (i == fill)
-            ++fill;
+        for (int i = 1; i < fill; ++i)
+            counter[i].merge(counter[i - 1]);
+        // 此时*this已空，以splice取回节点
+        splice(end(), counter[fill - 1]);
     }
-    for (int i = 1; i < fill; ++i)
-        counter[i].merge(counter[i - 1]);
-    swap(counter[fill - 1]);
+    catch(...) {
+        Destroy(counter, counter + fill);
+        throw;
+    }
+    Destroy(counter, counter + fill);
 }
 
-#endif
\ No newline at end of file
+// 以memory_resource配置空间的list，资源可在运行期选择
+template <class T>
+using pmr_list = list<T, polymorphic_alloc>;
+
+#endif
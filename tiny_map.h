@@ -2,18 +2,19 @@
 #define __TINY_MAP_H
 
 #include "tiny_tree.h"
+#include "tiny_memory_resource.h"
 #include <functional>
 
-template <class Key, class T, class Compare = less<Key>>
+template <class Key, class T, class Compare = less<Key>, class Alloc = alloc>
 class map;
 
-template <class Key, class T, class Compare>
-inline bool operator==(const map<Key, T, Compare> &x, const map<Key, T, Compare> &y);
+template <class Key, class T, class Compare, class Alloc>
+inline bool operator==(const map<Key, T, Compare, Alloc> &x, const map<Key, T, Compare, Alloc> &y);
 
-template <class Key, class T, class Compare>
-inline bool operator<(const map<Key, T, Compare> &x, const map<Key, T, Compare> &y);
+template <class Key, class T, class Compare, class Alloc>
+inline bool operator<(const map<Key, T, Compare, Alloc> &x, const map<Key, T, Compare, Alloc> &y);
 
-template <class Key, class T, class Compare>
+template <class Key, class T, class Compare, class Alloc>
 class map {
     public:
         // typedfe:
@@ -25,7 +26,7 @@ class map {
 
     // 以下定义一个functor，其作用就是调用元素比较函数
         class value_compare : public binary_function<value_type, value_type, bool> {
-            friend class map<Key, T, Compare>;
+            friend class map<Key, T, Compare, Alloc>;
             protected:
                 Compare comp;
                 value_compare(Compare c) : comp(c) {}
@@ -38,7 +39,7 @@ class map {
     private:
         // 以下定义表述型别，以map元素型别的第一型别
         // 作为RB-tree节点的键值型别
-        typedef rb_tree<key_type, value_type, _Select1st<value_type>, key_compare> rep_type;
+        typedef rb_tree<key_type, value_type, _Select1st<value_type>, key_compare, Alloc> rep_type;
         rep_type t;     // 以红黑树(RB-Tree)表现map
     public:
         typedef typename rep_type::pointer pointer;
@@ -53,6 +54,7 @@ class map {
         typedef typename rep_type::const_reverse_iterator const_reverse_iterator;
         typedef typename rep_type::size_type size_type;
         typedef typename rep_type::difference_type difference_type;
+        typedef typename rep_type::allocator_type allocator_type;
 
         // allocation/deallocation
         // 注意，map一定使用底层RB-tree的insert_unique()而非insert_equal()
@@ -60,7 +62,8 @@ class map {
         // 因为map不允许相同键值存在，multimap才允许相同键值存在
 
         map() : t(Compare()) {}
-        explicit map(const Compare& comp) : t(comp) {}
+        explicit map(const Compare& comp, const allocator_type& a = allocator_type())
+            : t(comp, a) {}
 
         template <class InputIterator>
         map(InputIterator first, InputIterator last) : t(Compare()) {
@@ -71,8 +74,8 @@ class map {
         map(InputIterator first, InputIterator last, const Compare &comp)
             : t(comp) { t.insert_unique(first, last); }
         
-        map(const map<Key,T,Compare>& x) : t(x.t) {}
-        map<Key, T, Compare> &operator=(const map<Key, T, Compare> &x) {
+        map(const map<Key, T, Compare, Alloc>& x) : t(x.t) {}
+        map<Key, T, Compare, Alloc> &operator=(const map<Key, T, Compare, Alloc> &x) {
             t = x.t;
             return *this;
         }
@@ -80,6 +83,7 @@ class map {
         // 以下所有的map操作行为，RB-tree都已经提供，map只需转调用即可
 
         key_compare key_comp() const { return t.key_comp(); }
+        allocator_type get_allocator() const { return t.get_allocator(); }
         value_compare value_comp() const { return value_compare(t.key_comp()); }
         iterator begin() { return t.begin(); }
         const_iterator begin() const { return t.begin(); }
@@ -96,7 +100,7 @@ class map {
         T& operator[](const key_type& k) {
             return (*((insert(value_type(k, T()))).first)).second;
         }
-        void swap(map<Key, T, Compare> &x) { t.swap(x.t); }
+        void swap(map<Key, T, Compare, Alloc> &x) { t.swap(x.t); }
 
         // insert/erase
         pair<iterator,bool> insert(const value_type& x) {
@@ -137,13 +141,17 @@ class map {
         friend bool operator< <>(const map &x, const map &y);
 };
 
-template <class Key, class T, class Compare>
-inline bool operator==(const map<Key, T, Compare> &x, const map<Key, T, Compare> &y) {
+template <class Key, class T, class Compare, class Alloc>
+inline bool operator==(const map<Key, T, Compare, Alloc> &x, const map<Key, T, Compare, Alloc> &y) {
     return x.t == y.t;
 }
-template <class Key, class T, class Compare>
-inline bool operator<(const map<Key, T, Compare> &x, const map<Key, T, Compare> &y) {
+template <class Key, class T, class Compare, class Alloc>
+inline bool operator<(const map<Key, T, Compare, Alloc> &x, const map<Key, T, Compare, Alloc> &y) {
     return x.t < y.t;
 }
 
-#endif
\ No newline at end of file
+// 以memory_resource配置空间的map，资源可在运行期选择
+template <class Key, class T, class Compare = less<Key>>
+using pmr_map = map<Key, T, Compare, polymorphic_alloc>;
+
+#endif
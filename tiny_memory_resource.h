@@ -0,0 +1,443 @@
+#ifndef __TINY_MEMORY_RESOURCE_H
+#define __TINY_MEMORY_RESOURCE_H
+
+#include <cstddef>
+#include <mutex>
+#include "tiny_alloc.h"
+
+// 运行期多态的内存资源
+// 同一个容器型别(例如pmr_map<int,int>)可以在运行期改用不同的内存来源，
+// 例如每个请求各自一块arena，请求结束时整块释放
+class memory_resource {
+public:
+    enum { max_align = sizeof(void*) * 2 };
+
+    virtual ~memory_resource() {}
+
+    void* allocate(size_t bytes, size_t alignment = max_align) {
+        return do_allocate(bytes, alignment);
+    }
+    void deallocate(void *p, size_t bytes, size_t alignment = max_align) {
+        do_deallocate(p, bytes, alignment);
+    }
+    bool is_equal(const memory_resource &other) const {
+        return do_is_equal(other);
+    }
+    // deallocate()是否为空操作，若是，容器清空时可以不逐一归还节点
+    bool release_only() const { return do_release_only(); }
+
+protected:
+    virtual void* do_allocate(size_t bytes, size_t alignment) = 0;
+    virtual void do_deallocate(void *p, size_t bytes, size_t alignment) = 0;
+    virtual bool do_is_equal(const memory_resource &other) const {
+        return this == &other;
+    }
+    virtual bool do_release_only() const { return false; }
+};
+
+inline bool operator==(const memory_resource &a, const memory_resource &b) {
+    return &a == &b || a.is_equal(b);
+}
+
+inline bool operator!=(const memory_resource &a, const memory_resource &b) {
+    return !(a == b);
+}
+
+// 以第一级配置器(malloc/free)实现的资源，是默认资源
+// malloc只保证max_align的对齐，更大的对齐改用posix_memalign(Windows为_aligned_malloc)，
+// 归还时须传入与配置时相同的alignment，才能分派到相应的释放函数
+class __malloc_resource : public memory_resource {
+protected:
+    virtual void* do_allocate(size_t bytes, size_t alignment) {
+        if (alignment <= (size_t)max_align)
+            return malloc_alloc::allocate(bytes);
+        return aligned_allocate(bytes, alignment);
+    }
+    virtual void do_deallocate(void *p, size_t bytes, size_t alignment) {
+        if (alignment <= (size_t)max_align)
+            malloc_alloc::deallocate(p, bytes);
+        else
+            aligned_deallocate(p);
+    }
+
+private:
+    static void* aligned_allocate(size_t bytes, size_t alignment) {
+        void *result;
+#if defined(_WIN32)
+        result = _aligned_malloc(bytes, alignment);
+#else
+        if (posix_memalign(&result, alignment, bytes) != 0)
+            result = 0;
+#endif
+        if (0 == result)
+            __THROW_BAD_ALLOC;
+        return result;
+    }
+    static void aligned_deallocate(void *p) {
+#if defined(_WIN32)
+        _aligned_free(p);
+#else
+        free(p);
+#endif
+    }
+};
+
+template <int inst>
+struct __memory_resource_globals {
+    static __malloc_resource malloc_resource;
+    static memory_resource *default_resource;
+};
+
+template <int inst>
+__malloc_resource __memory_resource_globals<inst>::malloc_resource;
+
+template <int inst>
+memory_resource *__memory_resource_globals<inst>::default_resource =
+    &__memory_resource_globals<inst>::malloc_resource;
+
+inline memory_resource* new_delete_resource() {
+    return &__memory_resource_globals<0>::malloc_resource;
+}
+
+inline memory_resource* get_default_resource() {
+    return __memory_resource_globals<0>::default_resource;
+}
+
+// 传入0表示恢复为new_delete_resource()，返回原来的默认资源
+inline memory_resource* set_default_resource(memory_resource *r) {
+    memory_resource *old = __memory_resource_globals<0>::default_resource;
+    __memory_resource_globals<0>::default_resource = r ? r : new_delete_resource();
+    return old;
+}
+
+inline size_t __align_up(size_t n, size_t alignment) {
+    return (n + alignment - 1) & ~(alignment - 1);
+}
+
+// 单调增长的缓冲区资源：只配置不归还，release()或析构时一次释放全部
+// deallocate()是空操作，因此rb_tree、hashtable清空时会跳过逐个节点的归还
+class monotonic_buffer_resource : public memory_resource {
+public:
+    explicit monotonic_buffer_resource(memory_resource *upstream = get_default_resource())
+        : upstream_(upstream), chunks_(0), initial_buffer_(0), initial_size_(0),
+          cur_(0), end_(0), next_size_(__initial_chunk_size) {}
+
+    explicit monotonic_buffer_resource(size_t initial_size,
+                                       memory_resource *upstream = get_default_resource())
+        : upstream_(upstream), chunks_(0), initial_buffer_(0), initial_size_(0),
+          cur_(0), end_(0), next_size_(initial_size ? initial_size : 1) {}
+
+    // 先使用用户提供的buffer，用完再向upstream配置
+    monotonic_buffer_resource(void *buffer, size_t buffer_size,
+                              memory_resource *upstream = get_default_resource())
+        : upstream_(upstream), chunks_(0), initial_buffer_((char *)buffer),
+          initial_size_(buffer_size), cur_((char *)buffer), end_((char *)buffer + buffer_size),
+          next_size_(buffer_size > (size_t)__initial_chunk_size / 2 ? buffer_size * 2 : (size_t)__initial_chunk_size) {}
+
+    ~monotonic_buffer_resource() { release(); }
+
+    // 把向upstream配置的所有chunk一次归还，回到初始buffer
+    void release() {
+        while (chunks_ != 0) {
+            chunk *next = chunks_->next;
+            upstream_->deallocate(chunks_, chunks_->size);
+            chunks_ = next;
+        }
+        cur_ = initial_buffer_;
+        end_ = initial_buffer_ + initial_size_;
+    }
+
+    memory_resource* upstream_resource() const { return upstream_; }
+
+private:
+    enum { __initial_chunk_size = 1024 };
+
+    struct chunk {      // 每个chunk的头部，串接所有向upstream配置的空间
+        chunk *next;
+        size_t size;
+    };
+
+    monotonic_buffer_resource(const monotonic_buffer_resource &);
+    monotonic_buffer_resource &operator=(const monotonic_buffer_resource &);
+
+    memory_resource *upstream_;
+    chunk *chunks_;
+    char *initial_buffer_;
+    size_t initial_size_;
+    char *cur_;         // 目前chunk中尚未使用空间的起点
+    char *end_;         // 目前chunk的尾端
+    size_t next_size_;  // 下一个chunk的大小，每次翻倍
+
+protected:
+    virtual void* do_allocate(size_t bytes, size_t alignment) {
+        if (bytes == 0)
+            bytes = 1;
+        char *p = (char *)__align_up((size_t)cur_, alignment);
+        if (cur_ == 0 || p + bytes > end_) {
+            // 目前chunk不够用，向upstream配置新chunk，大小至少能容纳本次需求
+            size_t need = sizeof(chunk) + bytes + alignment;
+            size_t size = next_size_ > need ? next_size_ : need;
+            chunk *c = (chunk *)upstream_->allocate(size);
+            c->next = chunks_;
+            c->size = size;
+            chunks_ = c;
+            cur_ = (char *)(c + 1);
+            end_ = (char *)c + size;
+            next_size_ = size * 2;
+            p = (char *)__align_up((size_t)cur_, alignment);
+        }
+        cur_ = p + bytes;
+        return p;
+    }
+    virtual void do_deallocate(void *, size_t, size_t) {}
+    virtual bool do_release_only() const { return true; }
+};
+
+// pool resource的参数
+struct pool_options {
+    size_t max_blocks_per_chunk;            // 每次向upstream配置的chunk最多容纳的区块数
+    size_t largest_required_pool_block;     // 大于此值的区块直接向upstream配置
+
+    pool_options() : max_blocks_per_chunk(0), largest_required_pool_block(0) {}
+};
+
+// 非同步的pool resource：区块大小以2的幂分级，每级一个free-list
+// 超过最大级别的区块直接交给upstream，release()或析构时全部归还
+class unsynchronized_pool_resource : public memory_resource {
+public:
+    explicit unsynchronized_pool_resource(memory_resource *upstream = get_default_resource())
+        : upstream_(upstream) { init(pool_options()); }
+
+    unsynchronized_pool_resource(const pool_options &opts,
+                                 memory_resource *upstream = get_default_resource())
+        : upstream_(upstream) { init(opts); }
+
+    ~unsynchronized_pool_resource() { release(); }
+
+    void release() {
+        for (size_t i = 0; i < __npools; ++i) {
+            pool &p = pools_[i];
+            while (p.chunks != 0) {
+                chunk *next = p.chunks->next;
+                upstream_->deallocate(p.chunks, p.chunks->size, chunk_alignment(i));
+                p.chunks = next;
+            }
+            p.free_list = 0;
+            p.blocks_per_chunk = 0;
+        }
+        while (large_ != 0) {
+            large_block *next = large_->next;
+            if (next != 0)
+                next->prev = 0;
+            upstream_->deallocate(large_, large_->size, large_->alignment);
+            large_ = next;
+        }
+    }
+
+    memory_resource* upstream_resource() const { return upstream_; }
+    pool_options options() const { return opts_; }
+
+protected:
+    virtual void* do_allocate(size_t bytes, size_t alignment) {
+        size_t index = pool_index(bytes, alignment);
+        if (index == __npools)
+            return allocate_large(bytes, alignment);
+        pool &p = pools_[index];
+        if (p.free_list == 0)
+            refill(p, index);
+        block *result = p.free_list;
+        p.free_list = result->next;
+        return result;
+    }
+    virtual void do_deallocate(void *ptr, size_t bytes, size_t alignment) {
+        size_t index = pool_index(bytes, alignment);
+        if (index == __npools) {
+            deallocate_large(ptr, alignment);
+            return;
+        }
+        block *b = (block *)ptr;
+        b->next = pools_[index].free_list;
+        pools_[index].free_list = b;
+    }
+
+private:
+    enum { __min_block = 8 };
+    enum { __npools = 10 };     // 8, 16, 32, ... 4096
+    enum { __default_blocks_per_chunk = 64 };
+    enum { __max_blocks_per_chunk = 4096 };
+
+    struct block { block *next; };
+    struct chunk { chunk *next; size_t size; };
+    struct large_block {        // 大区块的头部，以双向链表串接，以便release()
+        large_block *next;
+        large_block *prev;
+        size_t size;
+        size_t alignment;       // 向upstream配置时的对齐，归还时原样传回
+    };
+    struct pool {
+        block *free_list;
+        chunk *chunks;
+        size_t blocks_per_chunk;    // 每次refill的区块数，逐次翻倍直到上限
+    };
+
+    unsynchronized_pool_resource(const unsynchronized_pool_resource &);
+    unsynchronized_pool_resource &operator=(const unsynchronized_pool_resource &);
+
+    memory_resource *upstream_;
+    pool_options opts_;
+    size_t npools_;             // 实际启用的级别数
+    pool pools_[__npools];
+    large_block *large_;
+
+    void init(const pool_options &opts) {
+        opts_ = opts;
+        if (opts_.max_blocks_per_chunk == 0 || opts_.max_blocks_per_chunk > __max_blocks_per_chunk)
+            opts_.max_blocks_per_chunk = __max_blocks_per_chunk;
+        size_t largest = (size_t)__min_block << (__npools - 1);
+        if (opts_.largest_required_pool_block == 0 || opts_.largest_required_pool_block > largest)
+            opts_.largest_required_pool_block = largest;
+        npools_ = 0;
+        while (((size_t)__min_block << npools_) < opts_.largest_required_pool_block)
+            ++npools_;
+        ++npools_;
+        opts_.largest_required_pool_block = (size_t)__min_block << (npools_ - 1);
+        for (size_t i = 0; i < __npools; ++i) {
+            pools_[i].free_list = 0;
+            pools_[i].chunks = 0;
+            pools_[i].blocks_per_chunk = 0;
+        }
+        large_ = 0;
+    }
+
+    // 区块大小所属的级别，无法由pool供应时返回__npools
+    size_t pool_index(size_t bytes, size_t alignment) const {
+        size_t n = bytes > alignment ? bytes : alignment;
+        size_t i = 0;
+        while (i < npools_ && ((size_t)__min_block << i) < n)
+            ++i;
+        // 区块按其大小自然对齐，对齐要求超过区块大小的交给upstream
+        return i < npools_ ? i : (size_t)__npools;
+    }
+
+    // 第index级的chunk向upstream要求的对齐：区块按其大小自然对齐
+    static size_t chunk_alignment(size_t index) {
+        size_t block_size = (size_t)__min_block << index;
+        return block_size < (size_t)max_align ? (size_t)max_align : block_size;
+    }
+
+    void refill(pool &p, size_t index) {
+        size_t block_size = (size_t)__min_block << index;
+        if (p.blocks_per_chunk == 0)
+            p.blocks_per_chunk = (size_t)__default_blocks_per_chunk < opts_.max_blocks_per_chunk
+                                 ? (size_t)__default_blocks_per_chunk : opts_.max_blocks_per_chunk;
+        size_t header = __align_up(sizeof(chunk), block_size);
+        size_t size = header + block_size * p.blocks_per_chunk;
+        chunk *c = (chunk *)upstream_->allocate(size, chunk_alignment(index));
+        c->next = p.chunks;
+        c->size = size;
+        p.chunks = c;
+        // 把chunk切成区块，串成free-list
+        char *first = (char *)c + header;
+        for (size_t i = p.blocks_per_chunk; i > 0; --i) {
+            block *b = (block *)(first + (i - 1) * block_size);
+            b->next = p.free_list;
+            p.free_list = b;
+        }
+        if (p.blocks_per_chunk * 2 <= opts_.max_blocks_per_chunk)
+            p.blocks_per_chunk *= 2;
+    }
+
+    void* allocate_large(size_t bytes, size_t alignment) {
+        if (alignment < (size_t)max_align)
+            alignment = max_align;
+        size_t offset = __align_up(sizeof(large_block), alignment);
+        size_t size = offset + bytes;
+        large_block *h = (large_block *)upstream_->allocate(size, alignment);
+        h->size = size;
+        h->alignment = alignment;
+        h->prev = 0;
+        h->next = large_;
+        if (large_ != 0)
+            large_->prev = h;
+        large_ = h;
+        return (char *)h + offset;
+    }
+
+    void deallocate_large(void *ptr, size_t alignment) {
+        // 头部位于使用者指针之前，偏移量与配置时一样由alignment算出
+        if (alignment < (size_t)max_align)
+            alignment = max_align;
+        large_block *h = (large_block *)((char *)ptr - __align_up(sizeof(large_block), alignment));
+        if (h->prev != 0)
+            h->prev->next = h->next;
+        else
+            large_ = h->next;
+        if (h->next != 0)
+            h->next->prev = h->prev;
+        upstream_->deallocate(h, h->size, h->alignment);
+    }
+};
+
+// 同步的pool resource：以互斥锁保护unsynchronized_pool_resource
+class synchronized_pool_resource : public memory_resource {
+public:
+    explicit synchronized_pool_resource(memory_resource *upstream = get_default_resource())
+        : impl_(upstream) {}
+
+    synchronized_pool_resource(const pool_options &opts,
+                               memory_resource *upstream = get_default_resource())
+        : impl_(opts, upstream) {}
+
+    void release() {
+        std::lock_guard<std::mutex> guard(lock_);
+        impl_.release();
+    }
+
+    memory_resource* upstream_resource() const { return impl_.upstream_resource(); }
+    pool_options options() const { return impl_.options(); }
+
+protected:
+    virtual void* do_allocate(size_t bytes, size_t alignment) {
+        std::lock_guard<std::mutex> guard(lock_);
+        return impl_.allocate(bytes, alignment);
+    }
+    virtual void do_deallocate(void *p, size_t bytes, size_t alignment) {
+        std::lock_guard<std::mutex> guard(lock_);
+        impl_.deallocate(p, bytes, alignment);
+    }
+
+private:
+    unsynchronized_pool_resource impl_;
+    std::mutex lock_;
+};
+
+// 以memory_resource为底的配置器，可直接作为容器的Alloc参数
+// 它是有状态的：每个容器保存一个memory_resource指针
+class polymorphic_alloc {
+public:
+    polymorphic_alloc() : resource_(get_default_resource()) {}
+    polymorphic_alloc(memory_resource *r) : resource_(r) {}
+
+    void* allocate(size_t n) { return resource_->allocate(n); }
+    void deallocate(void *p, size_t n) { resource_->deallocate(p, n); }
+
+    memory_resource* resource() const { return resource_; }
+
+private:
+    memory_resource *resource_;
+};
+
+inline bool operator==(const polymorphic_alloc &a, const polymorphic_alloc &b) {
+    return *a.resource() == *b.resource();
+}
+
+inline bool operator!=(const polymorphic_alloc &a, const polymorphic_alloc &b) {
+    return !(a == b);
+}
+
+// 资源的deallocate()为空操作时，容器清空可跳过逐个节点的归还
+inline bool __deallocate_is_noop(const polymorphic_alloc &a) {
+    return a.resource()->release_only();
+}
+
+#endif
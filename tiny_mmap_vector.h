@@ -0,0 +1,366 @@
+#ifndef __TINY_MMAP_VECTOR_H
+#define __TINY_MMAP_VECTOR_H
+
+#include <algorithm>
+#include <iterator>
+#include <system_error>
+#include <type_traits>
+#include <cerrno>
+#include "tiny_alloc.h"
+
+#ifndef __TINY_USE_MMAP
+#   error "mmap_vector requires mmap/mremap (Linux)"
+#endif
+
+#include <fcntl.h>
+#include <sys/stat.h>
+
+// mmap_vector<T>：元素存放在以MAP_SHARED映射的文件里，接口与tiny_vector.h的vector相同
+// 进程结束后内容仍留在文件中，下次以同一路径打开时只需映射文件，不必重建或反序列化
+// 元素必须可逐位复制：文件中保存的就是元素的bytes，不能含有指向进程内存的指针
+//
+// 文件开头是__mmap_vector_header，记录元素大小与个数，元素从第一个cache line之后开始
+// 空间不足时以ftruncate()加长文件，再以mremap()扩大映射，已有的页不必复制
+// 修改先写入page cache，由内核择时写回；sync()以msync()立即写回磁盘
+// 以默认构造函数产生的mmap_vector不对应文件，改用匿名映射，程序结束即消失
+
+struct __mmap_vector_header {
+    unsigned long long magic;       // 文件标识，用以拒绝打开无关的文件
+    unsigned long long elem_size;   // 元素大小，不符时拒绝打开
+    unsigned long long count;       // 元素个数，每次改动随即更新
+    unsigned long long reserved;
+};
+
+static const unsigned long long __MMAP_VECTOR_MAGIC = 0x544e59564d4d4150ULL;
+
+template <class T>
+class mmap_vector {
+    static_assert(is_trivially_copyable<T>::value, "mmap_vector requires a trivially copyable type");
+
+    public:
+        typedef T value_type;
+        typedef value_type *pointer;
+        typedef const value_type* const_pointer;
+        typedef value_type *iterator;
+        typedef const value_type* const_iterator;
+        typedef value_type &reference;
+        typedef const value_type& const_reference;
+        typedef size_t size_type;
+        typedef ptrdiff_t difference_type;
+
+        typedef reverse_iterator<const_iterator> const_reverse_iterator;
+        typedef reverse_iterator<iterator> reverse_iterator;
+
+    protected:
+        // 元素区相对于文件开头的位移，至少一个cache line，且满足T的对齐要求
+        static const size_type data_offset =
+            alignof(T) > 64 ? alignof(T) : 64;
+
+        int fd;             // 映射的文件，-1表示匿名映射或尚未映射
+        char* base;         // 映射的起点，0表示尚未映射
+        size_type mapped;   // 映射的bytes数，即文件大小
+        iterator start;
+        iterator finish;
+        iterator end_of_storage;
+
+        __mmap_vector_header* header() { return (__mmap_vector_header*)base; }
+
+        static void throw_errno(const char* what) {
+            throw system_error(errno, generic_category(), what);
+        }
+        // 依映射起点与大小重新计算各指针，元素个数取自文件头
+        void attach() {
+            start = (iterator)(base + data_offset);
+            finish = start + header()->count;
+            end_of_storage = start + (mapped - data_offset) / sizeof(T);
+        }
+        void set_finish(iterator p) {
+            finish = p;
+            header()->count = finish - start;
+        }
+        // 把映射(与文件)扩充为bytes大小，内容保持不变
+        void remap(size_type bytes);
+        // 备用空间不足n个元素时，扩充为原大小的两倍，或原大小+n
+        void reserve_for_insert(size_type n) {
+            if (size_type(end_of_storage - finish) < n)
+                reserve(size() + max(size(), n));
+        }
+
+    public:
+        iterator begin() { return start; }
+        const_iterator begin() const { return start; }
+        iterator end() { return finish; }
+        const_iterator end() const { return finish; }
+
+        reverse_iterator rbegin() { return reverse_iterator(end()); }
+        const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+        reverse_iterator rend() { return reverse_iterator(begin()); }
+        const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+        pointer data() { return start; }
+        const_pointer data() const { return start; }
+
+        size_type size() const { return size_type(end() - begin()); }
+        size_type max_size() const { return size_type(-1) / sizeof(T); }
+        size_type capacity() const { return size_type(end_of_storage - begin()); }
+        bool empty() const { return begin() == end(); }
+        bool is_open() const { return fd >= 0; }
+
+        reference operator[](size_type n) { return *(begin() + n); }
+        const_reference operator[](size_type n) const { return *(begin() + n); }
+        reference at(size_type n) { return (*this)[n]; }
+        const_reference at(size_type n) const { return (*this)[n]; }
+
+        reference front() { return *begin(); }
+        const_reference front() const { return *begin(); }
+        reference back() { return *(end() - 1); }
+        const_reference back() const { return *(end() - 1); }
+
+    public:
+        mmap_vector() : fd(-1), base(0), mapped(0), start(0), finish(0), end_of_storage(0) {}
+        // 打开(或建立)path所指的文件并映射，已有的元素立即可用
+        explicit mmap_vector(const char* path)
+            : fd(-1), base(0), mapped(0), start(0), finish(0), end_of_storage(0) {
+            open(path);
+        }
+        mmap_vector(mmap_vector&& x) noexcept
+            : fd(x.fd), base(x.base), mapped(x.mapped),
+              start(x.start), finish(x.finish), end_of_storage(x.end_of_storage) {
+            x.fd = -1;
+            x.base = 0;
+            x.mapped = 0;
+            x.start = x.finish = x.end_of_storage = 0;
+        }
+        // 文件只能由一个mmap_vector拥有，不提供复制
+        mmap_vector(const mmap_vector&) = delete;
+        mmap_vector& operator=(const mmap_vector&) = delete;
+        mmap_vector& operator=(mmap_vector&& x) noexcept {
+            if (&x != this) {
+                close();
+                swap(x);
+            }
+            return *this;
+        }
+        ~mmap_vector() { close(); }
+
+        void open(const char* path);
+        // 解除映射并关闭文件，内容留在文件中
+        void close() {
+            if (base)
+                munmap(base, mapped);
+            if (fd >= 0)
+                ::close(fd);
+            fd = -1;
+            base = 0;
+            mapped = 0;
+            start = finish = end_of_storage = 0;
+        }
+        // 把修改立即写回文件
+        void sync() {
+            if (base && fd >= 0 && msync(base, mapped, MS_SYNC) != 0)
+                throw_errno("mmap_vector: msync");
+        }
+
+        void swap(mmap_vector& x) {
+            std::swap(fd, x.fd);
+            std::swap(base, x.base);
+            std::swap(mapped, x.mapped);
+            std::swap(start, x.start);
+            std::swap(finish, x.finish);
+            std::swap(end_of_storage, x.end_of_storage);
+        }
+
+        void reserve(size_type n) {
+            if (capacity() < n)
+                remap(data_offset + n * sizeof(T));
+        }
+        // 把文件缩短到恰好容纳现有元素(按页取整)
+        void shrink_to_fit() {
+            if (base)
+                remap(data_offset + size() * sizeof(T));
+        }
+
+        void push_back(const T& x) {
+            if (finish == end_of_storage) {
+                T x_copy = x;       // x可能正是mmap_vector中的元素，扩充后即失效
+                reserve_for_insert(1);
+                *finish = x_copy;
+            }
+            else
+                *finish = x;
+            set_finish(finish + 1);
+        }
+        template <class... Args>
+        void emplace_back(Args&&... args) {
+            push_back(T(std::forward<Args>(args)...));
+        }
+        void pop_back() { set_finish(finish - 1); }
+
+        iterator insert(iterator position, const T& x) {
+            const difference_type off = position - start;
+            insert(position, 1, x);
+            return start + off;
+        }
+        void insert(iterator position, size_type n, const T& x) {
+            if (n == 0)
+                return;
+            const difference_type off = position - start;
+            T x_copy = x;
+            reserve_for_insert(n);
+            position = start + off;
+            memmove((void*)(position + n), (const void*)position, (finish - position) * sizeof(T));
+            fill(position, position + n, x_copy);
+            set_finish(finish + n);
+        }
+        template <class InputIterator>
+        void insert(iterator position, InputIterator first, InputIterator last) {
+            insert_dispatch(position, first, last, is_integral<InputIterator>());
+        }
+
+        iterator erase(iterator position) {
+            return erase(position, position + 1);
+        }
+        iterator erase(iterator first, iterator last) {
+            if (first == last)      // 包括从未映射过的空mmap_vector
+                return first;
+            memmove((void*)first, (const void*)last, (finish - last) * sizeof(T));
+            set_finish(finish - (last - first));
+            return first;
+        }
+
+        void resize(size_type new_size, const T& x) {
+            if (new_size < size())
+                erase(begin() + new_size, end());
+            else
+                insert(end(), new_size - size(), x);
+        }
+        void resize(size_type new_size) { resize(new_size, T()); }
+        void clear() {
+            if (base)
+                set_finish(start);
+        }
+
+    protected:
+        template <class Integer>
+        void insert_dispatch(iterator position, Integer n, Integer x, true_type) {
+            insert(position, (size_type)n, (T)x);
+        }
+        template <class InputIterator>
+        void insert_dispatch(iterator position, InputIterator first, InputIterator last, false_type) {
+            range_insert(position, first, last, typename iterator_traits<InputIterator>::iterator_category());
+        }
+        // 输入迭代器：逐一追加到尾端，再旋转到插入点
+        template <class InputIterator>
+        void range_insert(iterator position, InputIterator first, InputIterator last, input_iterator_tag) {
+            const difference_type off = position - start;
+            const size_type old_size = size();
+            for ( ; first != last; ++first)
+                push_back(*first);
+            rotate(start + off, start + old_size, finish);
+        }
+        // 前向迭代器：先求出元素个数，只扩充一次
+        template <class ForwardIterator>
+        void range_insert(iterator position, ForwardIterator first, ForwardIterator last,
+                          forward_iterator_tag) {
+            const size_type n = distance(first, last);
+            if (n == 0)
+                return;
+            const difference_type off = position - start;
+            reserve_for_insert(n);
+            position = start + off;
+            memmove((void*)(position + n), (const void*)position, (finish - position) * sizeof(T));
+            copy(first, last, position);
+            set_finish(finish + n);
+        }
+};
+
+template <class T>
+void mmap_vector<T>::open(const char* path)
+{
+    close();
+    int f = ::open(path, O_RDWR | O_CREAT, 0644);
+    if (f < 0)
+        throw_errno("mmap_vector: open");
+    struct stat st;
+    if (fstat(f, &st) != 0) {
+        ::close(f);
+        throw_errno("mmap_vector: fstat");
+    }
+    size_type bytes = st.st_size;
+    const bool created = bytes == 0;
+    if (created) {
+        bytes = __page_round_up(data_offset);
+        if (ftruncate(f, bytes) != 0) {
+            ::close(f);
+            throw_errno("mmap_vector: ftruncate");
+        }
+    }
+    else if (bytes < data_offset) {
+        ::close(f);
+        throw system_error(make_error_code(errc::invalid_argument), "mmap_vector: not an mmap_vector file");
+    }
+    void* p = mmap(0, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, f, 0);
+    if (MAP_FAILED == p) {
+        ::close(f);
+        throw_errno("mmap_vector: mmap");
+    }
+    __mmap_vector_header* h = (__mmap_vector_header*)p;
+    if (created) {
+        h->magic = __MMAP_VECTOR_MAGIC;
+        h->elem_size = sizeof(T);
+        h->count = 0;
+    }
+    else if (h->magic != __MMAP_VECTOR_MAGIC || h->elem_size != sizeof(T) ||
+             h->count > (bytes - data_offset) / sizeof(T)) {
+        munmap(p, bytes);
+        ::close(f);
+        throw system_error(make_error_code(errc::invalid_argument), "mmap_vector: not an mmap_vector file");
+    }
+    fd = f;
+    base = (char*)p;
+    mapped = bytes;
+    attach();
+}
+
+template <class T>
+void mmap_vector<T>::remap(size_type bytes)
+{
+    bytes = __page_round_up(bytes);
+    if (fd >= 0 && ftruncate(fd, bytes) != 0)
+        throw_errno("mmap_vector: ftruncate");
+    void* p;
+    if (base == 0) {
+        // 尚未映射：未对应文件的mmap_vector第一次扩充，改用匿名映射
+        p = mmap(0, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (MAP_FAILED == p)
+            __THROW_BAD_ALLOC;
+        ((__mmap_vector_header*)p)->magic = __MMAP_VECTOR_MAGIC;
+        ((__mmap_vector_header*)p)->elem_size = sizeof(T);
+        ((__mmap_vector_header*)p)->count = 0;
+    }
+    else {
+        p = mremap(base, mapped, bytes, MREMAP_MAYMOVE);
+        if (MAP_FAILED == p)
+            throw_errno("mmap_vector: mremap");
+    }
+    base = (char*)p;
+    mapped = bytes;
+    attach();
+}
+
+template <class T>
+inline bool operator==(const mmap_vector<T>& x, const mmap_vector<T>& y) {
+    return x.size() == y.size() && equal(x.begin(), x.end(), y.begin());
+}
+
+template <class T>
+inline bool operator<(const mmap_vector<T>& x, const mmap_vector<T>& y) {
+    return lexicographical_compare(x.begin(), x.end(), y.begin(), y.end());
+}
+
+template <class T>
+inline bool operator!=(const mmap_vector<T>& x, const mmap_vector<T>& y) {
+    return !(x == y);
+}
+
+#endif
@@ -4,16 +4,16 @@
 #include "tiny_tree.h"
 #include <functional>
 
-template <class Key, class T, class Compare = less<Key>>
+template <class Key, class T, class Compare = less<Key>, class Alloc = alloc>
 class multimap;
 
-template <class Key, class T, class Compare>
-inline bool operator==(const multimap<Key, T, Compare> &x, const multimap<Key, T, Compare> &y);
+template <class Key, class T, class Compare, class Alloc>
+inline bool operator==(const multimap<Key, T, Compare, Alloc> &x, const multimap<Key, T, Compare, Alloc> &y);
 
-template <class Key, class T, class Compare>
-inline bool operator<(const multimap<Key, T, Compare> &x, const multimap<Key, T, Compare> &y);
+template <class Key, class T, class Compare, class Alloc>
+inline bool operator<(const multimap<Key, T, Compare, Alloc> &x, const multimap<Key, T, Compare, Alloc> &y);
 
-template <class Key, class T, class Compare>
+template <class Key, class T, class Compare, class Alloc>
 class multimap {
     public:
         // typedfe:
@@ -25,7 +25,7 @@ class multimap {
 
     // 以下定义一个functor，其作用就是调用元素比较函数
         class value_compare : public binary_function<value_type, value_type, bool> {
-            friend class multimap<Key, T, Compare>;
+            friend class multimap<Key, T, Compare, Alloc>;
             protected:
                 Compare comp;
                 value_compare(Compare c) : comp(c) {}
@@ -38,7 +38,7 @@ class multimap {
     private:
         // 以下定义表述型别，以map元素型别的第一型别
         // 作为RB-tree节点的键值型别
-        typedef rb_tree<key_type, value_type, _Select1st<value_type>, key_compare> rep_type;
+        typedef rb_tree<key_type, value_type, _Select1st<value_type>, key_compare, Alloc> rep_type;
         rep_type t;     // 以红黑树(RB-Tree)表现map
     public:
         typedef typename rep_type::pointer pointer;
@@ -53,6 +53,7 @@ class multimap {
         typedef typename rep_type::const_reverse_iterator const_reverse_iterator;
         typedef typename rep_type::size_type size_type;
         typedef typename rep_type::difference_type difference_type;
+        typedef typename rep_type::allocator_type allocator_type;
 
         // allocation/deallocation
         // 注意，map一定使用底层RB-tree的insert_unique()而非insert_equal()
@@ -60,7 +61,8 @@ class multimap {
         // 因为map不允许相同键值存在，multimap才允许相同键值存在
 
         multimap() : t(Compare()) {}
-        explicit multimap(const Compare& comp) : t(comp) {}
+        explicit multimap(const Compare& comp, const allocator_type& a = allocator_type())
+            : t(comp, a) {}
 
         template <class InputIterator>
         multimap(InputIterator first, InputIterator last) : t(Compare()) {
@@ -71,8 +73,8 @@ class multimap {
         multimap(InputIterator first, InputIterator last, const Compare &comp)
             : t(comp) { t.insert_equal(first, last); }
         
-        multimap(const multimap<Key,T,Compare>& x) : t(x.t) {}
-        multimap<Key, T, Compare> &operator=(const multimap<Key, T, Compare> &x) {
+        multimap(const multimap<Key, T, Compare, Alloc>& x) : t(x.t) {}
+        multimap<Key, T, Compare, Alloc> &operator=(const multimap<Key, T, Compare, Alloc> &x) {
             t = x.t;
             return *this;
         }
@@ -80,6 +82,7 @@ class multimap {
         // 以下所有的map操作行为，RB-tree都已经提供，map只需转调用即可
 
         key_compare key_comp() const { return t.key_comp(); }
+        allocator_type get_allocator() const { return t.get_allocator(); }
         value_compare value_comp() const { return value_compare(t.key_comp()); }
         iterator begin() { return t.begin(); }
         const_iterator begin() const { return t.begin(); }
@@ -93,7 +96,7 @@ class multimap {
         size_type size() const { return t.size(); }
         size_type max_size() const { return t.max_size(); }
         
-        void swap(map<Key, T, Compare> &x) { t.swap(x.t); }
+        void swap(map<Key, T, Compare, Alloc> &x) { t.swap(x.t); }
 
         // insert/erase
         iterator insert(const value_type& x) {
@@ -134,12 +137,12 @@ class multimap {
         friend bool operator< <>(const multimap &x, const multimap &y);
 };
 
-template <class Key, class T, class Compare>
-inline bool operator==(const multimap<Key, T, Compare> &x, const multimap<Key, T, Compare> &y) {
+template <class Key, class T, class Compare, class Alloc>
+inline bool operator==(const multimap<Key, T, Compare, Alloc> &x, const multimap<Key, T, Compare, Alloc> &y) {
     return x.t == y.t;
 }
-template <class Key, class T, class Compare>
-inline bool operator<(const multimap<Key, T, Compare> &x, const multimap<Key, T, Compare> &y) {
+template <class Key, class T, class Compare, class Alloc>
+inline bool operator<(const multimap<Key, T, Compare, Alloc> &x, const multimap<Key, T, Compare, Alloc> &y) {
     return x.t < y.t;
 }
 
@@ -4,16 +4,16 @@
 #include "tiny_tree.h"
 #include <functional>
 
-template <class Key,class Compare = less<Key> >
+template <class Key, class Compare = less<Key>, class Alloc = alloc>
 class set;
 
-template <class Key, class Compare>
-inline bool operator==(const set<Key,Compare>& x, const set<Key,Compare>& y);
+template <class Key, class Compare, class Alloc>
+inline bool operator==(const set<Key, Compare, Alloc>& x, const set<Key, Compare, Alloc>& y);
 
-template <class Key, class Compare>
-inline bool operator<(const set<Key,Compare>& x, const set<Key,Compare>& y);
+template <class Key, class Compare, class Alloc>
+inline bool operator<(const set<Key, Compare, Alloc>& x, const set<Key, Compare, Alloc>& y);
 
-template <class Key,class Compare>
+template <class Key, class Compare, class Alloc>
 class set {
     public:
         // typedefs
@@ -24,7 +24,7 @@ class set {
         typedef Compare value_compare;
     private:
         // 以下identity定义于<stl_functionh>
-        typedef rb_tree<key_type, value_type, std::_Identity<value_type>, key_compare> rep_type;
+        typedef rb_tree<key_type, value_type, std::_Identity<value_type>, key_compare, Alloc> rep_type;
         rep_type t;     // 采用红黑树(RB-tree)来表现set
     public:
         typedef typename rep_type::const_pointer poniter;
@@ -40,13 +40,15 @@ class set {
         typedef typename rep_type::const_reverse_iterator const_reverse_iterator;
         typedef typename rep_type::size_type size_type;
         typedef typename rep_type::difference_type difference_type;
+        typedef typename rep_type::allocator_type allocator_type;
 
         // allocation/deallocation
         // 注意，set一定使用RB-tree的insert_unique()而非insert_equal()
         // multiset才使用RB-tree的insert_equal()
         // 因为set不允许相同键值存在，multiset才允许相同键值存在
         set() : t(Compare()) {}
-        explicit set(const Compare& comp) : t(comp) {}
+        explicit set(const Compare& comp, const allocator_type& a = allocator_type())
+            : t(comp, a) {}
 
         template <class InputIterator>
         set(InputIterator first, InputIterator last)
@@ -56,8 +58,8 @@ class set {
         set(InputIterator first, InputIterator last, const Compare &comp)
             : t(comp) { t.insert_unique(first, last); }
         
-        set(const set<Key,Compare>& x) : t(x.t) {}
-        set<Key,Compare>& operator=(const set<Key,Compare>& x) {
+        set(const set<Key, Compare, Alloc>& x) : t(x.t) {}
+        set<Key, Compare, Alloc>& operator=(const set<Key, Compare, Alloc>& x) {
             t = x.t;
             return *this;
         }
@@ -65,6 +67,7 @@ class set {
         // 以下所有的set操作行为，RB-Tree都已提供，所以set只要传递参数调用即可
 
         key_compare key_comp() const { return t.key_comp(); }
+        allocator_type get_allocator() const { return t.get_allocator(); }
 
         value_compare value_comp() const { return t.key_comp(); }
 
@@ -75,7 +78,7 @@ class set {
         bool empty() const { return t.empty(); }
         size_type size() const { return t.size(); }
         size_type max_size() const { return t.max_size(); }
-        void swap(set<Key, Compare> &x) { t.swap(x.t); }
+        void swap(set<Key, Compare, Alloc> &x) { t.swap(x.t); }
 
         // insert/erase
         pair<typename rep_type::iterator, bool> insert(const value_type& x) {
@@ -116,13 +119,13 @@ class set {
         friend bool operator< <>(const set &, const set &);
 };
 
-template <class Key, class Compare>
-inline bool operator==(const set<Key, Compare> &x, const set<Key, Compare> &y) {
+template <class Key, class Compare, class Alloc>
+inline bool operator==(const set<Key, Compare, Alloc> &x, const set<Key, Compare, Alloc> &y) {
     return x.t = y.t;
 }
 
-template <class Key, class Compare>
-inline bool operator<(const set<Key, Compare> &x, const set<Key, Compare> &y) {
+template <class Key, class Compare, class Alloc>
+inline bool operator<(const set<Key, Compare, Alloc> &x, const set<Key, Compare, Alloc> &y) {
     return x.t < y.t;
 }
 
@@ -142,8 +142,8 @@ inline T* value_type(const __slist_iterator<T, Ref, Ptr>&) {
   return 0;
 }
 
-template <class T>
-class slist
+template <class T, class Alloc = alloc>
+class slist : protected simple_alloc<__slist_node<T>, Alloc>
 {
     public:
         typedef T value_type;
@@ -153,6 +153,7 @@ class slist
         typedef const value_type &const_reference;
         typedef size_t size_type;
         typedef ptrdiff_t difference_type;
+        typedef Alloc allocator_type;
 
         typedef __slist_iterator<T, T &, T *> iterator;
         typedef __slist_iterator<T, const T &, const T *> const_iterator;
@@ -186,7 +187,7 @@ class slist
         return node;
     }
 
-    static void destory_node(list_node* node) {
+    void destory_node(list_node* node) {
         Destroy(&node->data);       // 将元素析构
         put_node(node);      // 释放空间
     }
@@ -197,13 +198,18 @@ class slist
 
     public:
         slist() { head.next = 0; }
+        explicit slist(const allocator_type& a) : list_node_allocator(a) { head.next = 0; }
         slist(const_iterator first, const_iterator last) { insert_after_range(&this->head, first, last); }
         slist(const value_type* first, const value_type* last) { insert_after_range(&this->head, first, last); }
-        slist(const slist& x) { insert_after_range(&this->head, x.begin(), x.end()); }
+        slist(const slist& x) : list_node_allocator(x.get_allocator()) {
+            insert_after_range(&this->head, x.begin(), x.end());
+        }
 
         slist& operator= (const slist& x);
 
         ~slist() { clear(); }
+
+        allocator_type get_allocator() const { return list_node_allocator::get_allocator(); }
     public:
         iterator begin() { return iterator((list_node *)head.next); }
         const_iterator begin() const { return const_iterator((list_node *)head.next);}
@@ -218,16 +224,17 @@ class slist
 
         void clear() { this->erase_after(&this->head, 0); }
 
-        // 两个slist互换：只要将head交换互指即可
+        // 两个slist互换：只要将head交换互指即可，配置器随之交换
         void swap(slist& L)
         {
+            std::swap((list_node_allocator&)*this, (list_node_allocator&)L);
             list_node_base *tmp = head.next;
             head.next = L.head.next;
             L.head.next = tmp;
         }
 
     protected:
-        typedef simple_alloc<list_node> list_node_allocator;
+        typedef simple_alloc<list_node, Alloc> list_node_allocator;
         __slist_node<T>* get_node() { return list_node_allocator::allocate(1); }
         void put_node(__slist_node<T> *p) { list_node_allocator::deallocate(p, 1); }
 
@@ -325,11 +332,11 @@ class slist
             insert_after_fill(__slist_previous(&this->head, pos.node), n, x);
         }
         // 合并链表
-        void merge(slist<T> &x);
+        void merge(slist<T, Alloc> &x);
 };
 
-template <class T> 
-__slist_node_base* slist<T>::erase_after(__slist_node_base* before_first, __slist_node_base* last_node) {
+template <class T, class Alloc>
+__slist_node_base* slist<T, Alloc>::erase_after(__slist_node_base* before_first, __slist_node_base* last_node) {
     __slist_node<T> *cur = (__slist_node<T> *)(before_first->next);
     while (cur != last_node)
     {
@@ -342,8 +349,8 @@ __slist_node_base* slist<T>::erase_after(__slist_node_base* before_first, __slis
     return last_node;
 }
 
-template <class T>
-void slist<T>::resize(size_type len, const T& x)
+template <class T, class Alloc>
+void slist<T, Alloc>::resize(size_type len, const T& x)
 {
     __slist_node_base* cur = &this->head;
     while (cur->next != 0 && len > 0) {
@@ -356,8 +363,8 @@ void slist<T>::resize(size_type len, const T& x)
         insert_after_fill(cur, len, x);
 }
 
-template <class T>
-void slist<T>::merge(slist<T>& x)
+template <class T, class Alloc>
+void slist<T, Alloc>::merge(slist<T, Alloc>& x)
 {
     __slist_node_base* n1 = &this->head;
     while (n1->next && x.head.next) {
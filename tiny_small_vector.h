@@ -0,0 +1,531 @@
+#ifndef __TINY_SMALL_VECTOR_H
+#define __TINY_SMALL_VECTOR_H
+
+#include <algorithm>
+#include <iterator>
+#include <type_traits>
+#include "tiny_alloc.h"
+#include "tiny_memory_resource.h"
+#include "tiny_construct.h"
+
+// 带内部缓冲区的vector：元素不超过N个时放在对象本身之内，完全不向配置器要空间，
+// 超过N个才像vector一样配置堆上空间，之后即使元素减少也不再搬回内部缓冲区
+// 接口与tiny_vector.h的vector相同
+// 与vector不同之处：元素在内部缓冲区时，move与swap必须逐一搬移元素，
+// 因此指向元素的迭代器在move、swap之后失效
+template <class T, size_t N, class Alloc = alloc>
+class small_vector : protected simple_alloc<T, Alloc> {
+    public:
+        typedef T value_type;
+        typedef value_type *pointer;
+        typedef const value_type* const_pointer;
+        typedef value_type *iterator;
+        typedef const value_type* const_iterator;
+        typedef value_type &reference;
+        typedef const value_type& const_reference;
+        typedef size_t size_type;
+        typedef ptrdiff_t difference_type;
+        typedef Alloc allocator_type;
+
+        typedef reverse_iterator<const_iterator> const_reverse_iterator;
+        typedef reverse_iterator<iterator> reverse_iterator;
+
+    protected:
+        typedef simple_alloc<value_type, Alloc> data_allocator;
+        typedef is_trivially_relocatable<T> relocatable;
+        iterator start;     // 表示目前使用空间的头，指向内部缓冲区或堆上空间
+        iterator finish;    // 表示目前使用空间的尾
+        iterator end_of_storage;    // 表示目前可用空间的尾
+        // 内部缓冲区，N为0时仍保留一个元素大小，以免数组长度为0
+        alignas(T) unsigned char buffer[sizeof(T) * (N != 0 ? N : 1)];
+
+        iterator inline_start() { return (iterator)(void*)buffer; }
+        void inline_initialize() {
+            start = finish = inline_start();
+            end_of_storage = start + N;
+        }
+        // 准备容纳n个元素的空间：不超过N时使用内部缓冲区，否则配置
+        void storage_initialize(size_type n) {
+            if (n <= N)
+                inline_initialize();
+            else {
+                start = finish = data_allocator::allocate_at_least(n);
+                end_of_storage = start + n;
+            }
+        }
+        // 只有堆上空间需要归还
+        void deallocate() {
+            if (!is_inline())
+                data_allocator::deallocate(start, end_of_storage - start);
+        }
+        static iterator relocate(iterator first, iterator last, iterator result) {
+            size_type n = last - first;
+            if (n != 0)
+                memcpy((void*)result, (const void*)first, n * sizeof(T));
+            return result + n;
+        }
+        // 重新配置为至少n个元素的堆上空间，原有元素搬到新空间
+        void reallocate_storage(size_type n);
+        void insert_aux(iterator position, const T& x);
+        template <class... Args>
+        void realloc_insert(iterator position, Args&&... args);
+
+    public:
+        allocator_type get_allocator() const { return data_allocator::get_allocator(); }
+
+        iterator begin() { return start; }
+        const_iterator begin() const { return start; }
+
+        iterator end() { return finish; }
+        const_iterator end() const { return finish; }
+
+        reverse_iterator rbegin() { return reverse_iterator(end()); }
+        const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+
+        reverse_iterator rend() { return reverse_iterator(begin()); }
+        const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+        size_type size() const { return size_type(end() - begin()); }
+        size_type max_size() const { return size_type(-1) / sizeof(T); }
+        size_type capacity() const { return size_type(end_of_storage - begin()); }
+        bool empty() const { return begin() == end(); }
+        // 元素是否放在内部缓冲区
+        bool is_inline() const { return start == (const_iterator)(const void*)buffer; }
+
+        const_reference operator[](size_type n) const { return *(begin() + n); }
+        reference operator[](size_type n) { return *(begin() + n); }
+
+        reference at(size_type n) { return (*this)[n]; }
+        const_reference at(size_type n) const { return (*this)[n]; }
+
+        reference front() { return *begin(); }
+        reference back() { return *(end() - 1); }
+
+    public:
+        // 构造函数，不超过N个元素时都不配置空间
+        small_vector() { inline_initialize(); }
+        explicit small_vector(const allocator_type& a) : data_allocator(a) { inline_initialize(); }
+        explicit small_vector(size_type n) {
+            storage_initialize(n);
+            try {
+                finish = Construct_n(start, n);
+            }
+            catch(...) {
+                deallocate();
+                throw;
+            }
+        }
+        small_vector(size_type n, const T& value, const allocator_type& a = allocator_type())
+            : data_allocator(a) {
+            storage_initialize(n);
+            try {
+                finish = Uninitialized_fill_n(start, n, value);
+            }
+            catch(...) {
+                deallocate();
+                throw;
+            }
+        }
+        small_vector(const T* first, const T* last, const allocator_type& a = allocator_type())
+            : data_allocator(a) {
+            storage_initialize(last - first);
+            try {
+                finish = Uninitialized_copy(first, last, start);
+            }
+            catch(...) {
+                deallocate();
+                throw;
+            }
+        }
+        small_vector(const small_vector& x) : data_allocator(x) {
+            storage_initialize(x.size());
+            try {
+                finish = Uninitialized_copy(x.begin(), x.end(), start);
+            }
+            catch(...) {
+                deallocate();
+                throw;
+            }
+        }
+        // 移动构造函数：x在堆上时接管其空间，否则逐一搬移元素到自己的内部缓冲区
+        // 之后x都成为空的small_vector
+        small_vector(small_vector&& x) noexcept(is_nothrow_move_constructible<T>::value)
+            : data_allocator(x) {
+            if (!x.is_inline()) {
+                start = x.start;
+                finish = x.finish;
+                end_of_storage = x.end_of_storage;
+                x.inline_initialize();
+            }
+            else {
+                inline_initialize();
+                finish = Uninitialized_move_if_noexcept(x.start, x.finish, start);
+                x.clear();
+            }
+        }
+
+        ~small_vector() {
+            Destroy(start, finish);
+            deallocate();
+        }
+
+        small_vector& operator=(const small_vector& x);
+        small_vector& operator=(small_vector&& x) noexcept(is_nothrow_move_constructible<T>::value) {
+            if (&x != this) {
+                if (!x.is_inline()) {
+                    Destroy(start, finish);
+                    deallocate();
+                    (data_allocator&)*this = (data_allocator&)x;
+                    start = x.start;
+                    finish = x.finish;
+                    end_of_storage = x.end_of_storage;
+                    x.inline_initialize();
+                }
+                else {
+                    // x的元素必然放得进自己的空间(容量总是不小于N)
+                    clear();
+                    finish = Uninitialized_move_if_noexcept(x.start, x.finish, start);
+                    x.clear();
+                }
+            }
+            return *this;
+        }
+
+        void reserve(size_type n) {
+            if (capacity() < n)
+                reallocate_storage(n);
+        }
+
+        void push_back(const T& x) {
+            if (finish != end_of_storage) {
+                Construct(finish, x);
+                ++finish;
+            }
+            else
+                realloc_insert(finish, x);
+        }
+        void push_back(T&& x) { emplace_back(std::move(x)); }
+        template <class... Args>
+        void emplace_back(Args&&... args) {
+            if (finish != end_of_storage) {
+                Construct(finish, std::forward<Args>(args)...);
+                ++finish;
+            }
+            else
+                realloc_insert(finish, std::forward<Args>(args)...);
+        }
+
+        void pop_back() {
+            --finish;
+            Destroy(finish);
+        }
+
+        iterator erase(iterator position) {
+            if (position + 1 != end())
+                std::move(position + 1, finish, position);
+            --finish;
+            Destroy(finish);
+            return position;
+        }
+        iterator erase(iterator first, iterator last) {
+            iterator i = std::move(last, finish, first);
+            Destroy(i, finish);
+            finish = i;
+            return first;
+        }
+
+        void resize(size_type new_size, const T& x) {
+            if (new_size < size())
+                erase(begin() + new_size, end());
+            else
+                insert(end(), new_size - size(), x);
+        }
+        void resize(size_type new_size) { resize(new_size, T()); }
+        void clear() { erase(begin(), end()); }
+
+        void insert(iterator position, const T& x) { insert_aux(position, x); }
+        void insert(iterator position, size_type n, const T& x);
+
+        void swap(small_vector& x);
+};
+
+template <class T, size_t N, class Alloc>
+void small_vector<T, N, Alloc>::reallocate_storage(size_type n)
+{
+    const size_type old_size = size();
+    if (!is_inline() && relocatable::value) {
+        // 已在堆上且元素可逐位搬家：交给配置器的reallocate()，可能原地扩充
+        start = data_allocator::reallocate(start, capacity(), n);
+        finish = start + old_size;
+        end_of_storage = start + n;
+        return;
+    }
+    iterator tmp = data_allocator::allocate_at_least(n);
+    if (relocatable::value)
+        relocate(start, finish, tmp);
+    else {
+        try {
+            Uninitialized_move_if_noexcept(start, finish, tmp);
+        }
+        catch(...) {
+            data_allocator::deallocate(tmp, n);
+            throw;
+        }
+        Destroy(start, finish);
+    }
+    deallocate();
+    start = tmp;
+    finish = tmp + old_size;
+    end_of_storage = tmp + n;
+}
+
+// 在position处插入一个元素，元素初值为x
+template <class T, size_t N, class Alloc>
+void small_vector<T, N, Alloc>::insert_aux(iterator position, const T& x)
+{
+    if (finish == end_of_storage)
+        realloc_insert(position, x);
+    else if (position == finish) {
+        Construct(finish, x);
+        ++finish;
+    }
+    else {
+        T x_copy = x;       // x可能正是small_vector中的元素
+        Construct(finish, std::move(*(finish - 1)));
+        ++finish;
+        std::move_backward(position, finish - 2, finish - 1);
+        *position = std::move(x_copy);
+    }
+}
+
+// 空间不足时配置两倍大小的堆上空间，并在position处以args构造新元素
+template <class T, size_t N, class Alloc>
+template <class... Args>
+void small_vector<T, N, Alloc>::realloc_insert(iterator position, Args&&... args)
+{
+    const size_type old_size = size();
+    size_type len = old_size != 0 ? 2 * old_size : 1;
+
+    if (position == finish && !is_inline() && relocatable::value) {
+        T x_copy(std::forward<Args>(args)...);
+        start = data_allocator::reallocate(start, old_size, len);
+        finish = start + old_size;
+        end_of_storage = start + len;
+        Construct(finish, std::move(x_copy));
+        ++finish;
+        return;
+    }
+
+    iterator new_start = data_allocator::allocate_at_least(len);
+    iterator new_position = new_start + (position - start);
+    // 先构造新元素：参数可能正引用small_vector中的元素
+    try {
+        Construct(new_position, std::forward<Args>(args)...);
+    }
+    catch(...) {
+        data_allocator::deallocate(new_start, len);
+        throw;
+    }
+    iterator new_finish = new_start;
+    if (relocatable::value) {
+        relocate(start, position, new_start);
+        new_finish = relocate(position, finish, new_position + 1);
+    }
+    else {
+        try {
+            new_finish = Uninitialized_move_if_noexcept(start, position, new_start);
+            ++new_finish;
+            new_finish = Uninitialized_move_if_noexcept(position, finish, new_finish);
+        }
+        catch(...) {
+            if (new_finish == new_start)
+                Destroy(new_position);
+            else
+                Destroy(new_start, new_finish);
+            data_allocator::deallocate(new_start, len);
+            throw;
+        }
+        Destroy(start, finish);
+    }
+    deallocate();
+    start = new_start;
+    finish = new_finish;
+    end_of_storage = new_start + len;
+}
+
+// 从position开始，插入n个元素，元素初值为x
+template <class T, size_t N, class Alloc>
+void small_vector<T, N, Alloc>::insert(iterator position, size_type n, const T& x)
+{
+    if (n == 0)
+        return;
+    if (size_type(end_of_storage - finish) >= n) {
+        T x_copy = x;
+        const size_type elems_after = finish - position;
+        iterator old_finish = finish;
+        if (elems_after > n) {
+            Uninitialized_move_if_noexcept(finish - n, finish, finish);
+            finish += n;
+            std::move_backward(position, old_finish - n, old_finish);
+            fill(position, position + n, x_copy);
+        }
+        else {
+            Uninitialized_fill_n(finish, n - elems_after, x_copy);
+            finish += n - elems_after;
+            Uninitialized_move_if_noexcept(position, old_finish, finish);
+            finish += elems_after;
+            fill(position, old_finish, x_copy);
+        }
+        return;
+    }
+
+    const size_type old_size = size();
+    size_type len = old_size + max(old_size, n);
+    if (position == finish && !is_inline() && relocatable::value) {
+        T x_copy = x;
+        start = data_allocator::reallocate(start, capacity(), len);
+        finish = start + old_size;
+        end_of_storage = start + len;
+        finish = Uninitialized_fill_n(finish, n, x_copy);
+        return;
+    }
+    iterator new_start = data_allocator::allocate_at_least(len);
+    iterator new_position = new_start + (position - start);
+    try {
+        Uninitialized_fill_n(new_position, n, x);
+    }
+    catch(...) {
+        data_allocator::deallocate(new_start, len);
+        throw;
+    }
+    iterator new_finish = new_start;
+    if (relocatable::value) {
+        relocate(start, position, new_start);
+        new_finish = relocate(position, finish, new_position + n);
+    }
+    else {
+        try {
+            new_finish = Uninitialized_move_if_noexcept(start, position, new_start);
+            new_finish += n;
+            new_finish = Uninitialized_move_if_noexcept(position, finish, new_finish);
+        }
+        catch(...) {
+            if (new_finish == new_start)
+                Destroy(new_position, new_position + n);
+            else
+                Destroy(new_start, new_finish);
+            data_allocator::deallocate(new_start, len);
+            throw;
+        }
+        Destroy(start, finish);
+    }
+    deallocate();
+    start = new_start;
+    finish = new_finish;
+    end_of_storage = new_start + len;
+}
+
+template <class T, size_t N, class Alloc>
+small_vector<T, N, Alloc>& small_vector<T, N, Alloc>::operator=(const small_vector& x)
+{
+    if (&x != this) {
+        const size_type xlen = x.size();
+        if (xlen > capacity()) {
+            size_type len = xlen;
+            iterator tmp = data_allocator::allocate_at_least(len);
+            try {
+                Uninitialized_copy(x.begin(), x.end(), tmp);
+            }
+            catch(...) {
+                data_allocator::deallocate(tmp, len);
+                throw;
+            }
+            Destroy(start, finish);
+            deallocate();
+            start = tmp;
+            end_of_storage = start + len;
+        }
+        else if (size() >= xlen) {
+            iterator i = copy(x.begin(), x.end(), begin());
+            Destroy(i, finish);
+        }
+        else {
+            copy(x.begin(), x.begin() + size(), start);
+            Uninitialized_copy(x.begin() + size(), x.end(), finish);
+        }
+        finish = start + xlen;
+    }
+    return *this;
+}
+
+// 两者都在堆上时只交换指针；都在内部缓冲区时逐一交换元素，
+// 较长一方多出的元素搬到较短一方；一方在堆上时，先把另一方的元素搬进它空着的内部缓冲区，
+// 再把堆上空间交给另一方。堆上空间随配置器一起交换
+template <class T, size_t N, class Alloc>
+void small_vector<T, N, Alloc>::swap(small_vector& x)
+{
+    if (&x == this)
+        return;
+    if (!is_inline() && !x.is_inline()) {
+        std::swap(start, x.start);
+        std::swap(finish, x.finish);
+        std::swap(end_of_storage, x.end_of_storage);
+    }
+    else if (is_inline() && x.is_inline()) {
+        small_vector& s = size() < x.size() ? *this : x;   // 较短的一方
+        small_vector& l = size() < x.size() ? x : *this;
+        const size_type n = s.size();
+        std::swap_ranges(s.start, s.finish, l.start);
+        s.finish = Uninitialized_move_if_noexcept(l.start + n, l.finish, s.finish);
+        Destroy(l.start + n, l.finish);
+        l.finish = l.start + n;
+    }
+    else {
+        small_vector& h = is_inline() ? x : *this;     // 在堆上的一方
+        small_vector& i = is_inline() ? *this : x;     // 在内部缓冲区的一方
+        iterator new_finish = Uninitialized_move_if_noexcept(i.start, i.finish, h.inline_start());
+        Destroy(i.start, i.finish);
+        i.start = h.start;
+        i.finish = h.finish;
+        i.end_of_storage = h.end_of_storage;
+        h.inline_initialize();
+        h.finish = new_finish;
+    }
+    std::swap((data_allocator&)*this, (data_allocator&)x);
+}
+
+template <class T, size_t N, class Alloc>
+inline bool operator==(const small_vector<T, N, Alloc>& x, const small_vector<T, N, Alloc>& y) {
+    return x.size() == y.size() && equal(x.begin(), x.end(), y.begin());
+}
+
+template <class T, size_t N, class Alloc>
+inline bool operator<(const small_vector<T, N, Alloc>& x, const small_vector<T, N, Alloc>& y) {
+    return lexicographical_compare(x.begin(), x.end(), y.begin(), y.end());
+}
+
+template <class T, size_t N, class Alloc>
+inline bool operator!=(const small_vector<T, N, Alloc>& x, const small_vector<T, N, Alloc>& y) {
+    return !(x == y);
+}
+
+template <class T, size_t N, class Alloc>
+inline bool operator>(const small_vector<T, N, Alloc>& x, const small_vector<T, N, Alloc>& y) {
+    return y < x;
+}
+
+template <class T, size_t N, class Alloc>
+inline bool operator<=(const small_vector<T, N, Alloc>& x, const small_vector<T, N, Alloc>& y) {
+    return !(y < x);
+}
+
+template <class T, size_t N, class Alloc>
+inline bool operator>=(const small_vector<T, N, Alloc>& x, const small_vector<T, N, Alloc>& y) {
+    return !(x < y);
+}
+
+// 以memory_resource配置堆上空间的small_vector
+template <class T, size_t N>
+using pmr_small_vector = small_vector<T, N, polymorphic_alloc>;
+
+#endif
@@ -0,0 +1,353 @@
+#ifndef __TINY_SOA_VECTOR_H
+#define __TINY_SOA_VECTOR_H
+
+#include <algorithm>
+#include <iterator>
+#include <tuple>
+#include <utility>
+#include "tiny_alloc.h"
+#include "tiny_construct.h"
+
+// soa_vector<Fields...>：以"结构的数组"(struct of arrays)存放记录
+// 每个字段各占一段连续空间(一列)，所有列共用同一个元素个数与容量
+// 只扫描一两个字段时，取进缓存的都是用得到的数据；column<I>()传回第I列的普通指针，
+// 可直接交给SIMD核心或一般的指针算法处理
+//
+// 元素整体以tuple表示：value_type是tuple<Fields...>，
+// 迭代器取值得到的reference是tuple<Fields&...>代理，对它赋值即写回各列，
+// 因此copy、fill、accumulate等只需*it读写的算法都可直接使用
+// 但代理不是真正的引用，需要交换元素或取元素地址的算法(如sort)不适用
+
+// 各列起点对齐的字节数，兼顾cache line与最宽的SIMD载入指令
+#ifndef __TINY_SOA_ALIGN
+#define __TINY_SOA_ALIGN ((size_t)64)
+#endif
+
+// 迭代器：保存各列的起点与元素的索引，取值时才组成各字段的引用
+// IsConst为true时是const_iterator
+template <bool IsConst, class... Fields>
+struct __soa_iterator {
+    typedef random_access_iterator_tag iterator_category;
+    typedef tuple<Fields...> value_type;
+    typedef typename conditional<IsConst, tuple<const Fields&...>, tuple<Fields&...> >::type reference;
+    typedef void pointer;       // 代理引用没有对应的指针
+    typedef ptrdiff_t difference_type;
+    typedef __soa_iterator<IsConst, Fields...> self;
+    typedef tuple<typename conditional<IsConst, const Fields*, Fields*>::type...> column_pointers;
+
+    column_pointers columns;
+    difference_type index;
+
+    __soa_iterator() : index(0) {}
+    __soa_iterator(const column_pointers& c, difference_type i) : columns(c), index(i) {}
+    // iterator可转换为const_iterator
+    __soa_iterator(const __soa_iterator<false, Fields...>& x) : columns(x.columns), index(x.index) {}
+
+    reference operator*() const { return deref(index_sequence_for<Fields...>()); }
+    reference operator[](difference_type n) const { return *(*this + n); }
+
+    self& operator++() { ++index; return *this; }
+    self operator++(int) { self tmp = *this; ++index; return tmp; }
+    self& operator--() { --index; return *this; }
+    self operator--(int) { self tmp = *this; --index; return tmp; }
+    self& operator+=(difference_type n) { index += n; return *this; }
+    self& operator-=(difference_type n) { index -= n; return *this; }
+    self operator+(difference_type n) const { return self(columns, index + n); }
+    self operator-(difference_type n) const { return self(columns, index - n); }
+
+    // iterator与const_iterator之间也可相减、比较
+    template <bool C>
+    difference_type operator-(const __soa_iterator<C, Fields...>& x) const { return index - x.index; }
+    template <bool C>
+    bool operator==(const __soa_iterator<C, Fields...>& x) const { return index == x.index; }
+    template <bool C>
+    bool operator!=(const __soa_iterator<C, Fields...>& x) const { return index != x.index; }
+    template <bool C>
+    bool operator<(const __soa_iterator<C, Fields...>& x) const { return index < x.index; }
+    template <bool C>
+    bool operator>(const __soa_iterator<C, Fields...>& x) const { return x.index < index; }
+    template <bool C>
+    bool operator<=(const __soa_iterator<C, Fields...>& x) const { return index <= x.index; }
+    template <bool C>
+    bool operator>=(const __soa_iterator<C, Fields...>& x) const { return index >= x.index; }
+
+private:
+    template <size_t... I>
+    reference deref(index_sequence<I...>) const { return reference(get<I>(columns)[index]...); }
+};
+
+template <bool IsConst, class... Fields>
+inline __soa_iterator<IsConst, Fields...>
+operator+(ptrdiff_t n, const __soa_iterator<IsConst, Fields...>& x) {
+    return x + n;
+}
+
+template <class... Fields>
+class soa_vector : protected simple_alloc<char, alloc> {
+    static_assert(sizeof...(Fields) > 0, "soa_vector needs at least one field");
+    public:
+        typedef tuple<Fields...> value_type;
+        typedef tuple<Fields&...> reference;
+        typedef tuple<const Fields&...> const_reference;
+        typedef __soa_iterator<false, Fields...> iterator;
+        typedef __soa_iterator<true, Fields...> const_iterator;
+        typedef size_t size_type;
+        typedef ptrdiff_t difference_type;
+        typedef alloc allocator_type;
+
+        typedef reverse_iterator<const_iterator> const_reverse_iterator;
+        typedef reverse_iterator<iterator> reverse_iterator;
+
+        // 第I个字段的型别
+        template <size_t I>
+        using field_type = typename tuple_element<I, value_type>::type;
+
+    protected:
+        // 所有列放在同一个区块里，依序排列，每列起点按__TINY_SOA_ALIGN对齐
+        typedef simple_alloc<char, alloc> data_allocator;
+        typedef index_sequence_for<Fields...> indices;
+        typedef tuple<Fields*...> column_pointers;
+
+        char* block;        // 配置所得的区块，0表示尚未配置
+        column_pointers columns;
+        size_type count;        // 元素个数
+        size_type reserved;     // 每一列可容纳的元素个数
+
+        static size_type align_up(size_type n) {
+            return (n + __TINY_SOA_ALIGN - 1) & ~(__TINY_SOA_ALIGN - 1);
+        }
+        // 容纳n个元素所需的区块大小，多配置一段以便把区块起点调整到对齐处
+        static size_type block_bytes(size_type n) {
+            size_type bytes = __TINY_SOA_ALIGN;
+            size_type sizes[] = { align_up(n * sizeof(Fields))... };
+            for (size_type i = 0; i < sizeof...(Fields); ++i)
+                bytes += sizes[i];
+            return bytes;
+        }
+        // 在区块p中划分n个元素的各列
+        template <size_t... I>
+        static column_pointers layout(char* p, size_type n, index_sequence<I...>) {
+            char* cur = (char*)align_up((size_type)p);
+            column_pointers result;
+            ((get<I>(result) = (field_type<I>*)cur, cur += align_up(n * sizeof(field_type<I>))), ...);
+            return result;
+        }
+
+        // 以下对每一列做同样的事；某一列抛出异常时，析构已完成的各列(commit or rollback)
+        template <size_t... I>
+        static void destroy_columns(const column_pointers& c, size_type first, size_type last,
+                                    index_sequence<I...>) {
+            (Destroy(get<I>(c) + first, get<I>(c) + last), ...);
+        }
+        // 各列要么一律搬移、要么一律复制：只要有一列的move可能抛出就全部复制，
+        // 否则先搬走的列在后面的列抛出异常时已无法复原(不可复制的列只能搬移)
+        typedef integral_constant<bool, (is_nothrow_move_constructible<Fields>::value && ...)> move_all;
+        template <class T>
+        static void relocate_column(T* from, T* to, size_type n, true_type) {
+            Uninitialized_move_if_noexcept(from, from + n, to);
+        }
+        template <class T>
+        static void relocate_column(T* from, T* to, size_type n, false_type) {
+            __uninitialized_move_aux(from, from + n, to, integral_constant<bool, !is_copy_constructible<T>::value>());
+        }
+        template <size_t... I>
+        static void move_columns(const column_pointers& from, const column_pointers& to,
+                                 size_type n, index_sequence<I...>) {
+            size_type done = 0;
+            try {
+                ((relocate_column(get<I>(from), get<I>(to), n, move_all()), ++done), ...);
+            }
+            catch(...) {
+                ((I < done ? Destroy(get<I>(to), get<I>(to) + n) : void()), ...);
+                throw;
+            }
+        }
+        template <size_t... I>
+        static void copy_columns(const column_pointers& from, const column_pointers& to,
+                                 size_type n, index_sequence<I...>) {
+            size_type done = 0;
+            try {
+                ((Uninitialized_copy(get<I>(from), get<I>(from) + n, get<I>(to)), ++done), ...);
+            }
+            catch(...) {
+                ((I < done ? Destroy(get<I>(to), get<I>(to) + n) : void()), ...);
+                throw;
+            }
+        }
+        // 在第i行以args逐列构造各字段，args与各列一一对应
+        template <size_t... I, class... Args>
+        void construct_row(size_type i, index_sequence<I...>, Args&&... args) {
+            size_type done = 0;
+            try {
+                (((Construct(get<I>(columns) + i, std::forward<Args>(args))), ++done), ...);
+            }
+            catch(...) {
+                ((I < done ? Destroy(get<I>(columns) + i) : void()), ...);
+                throw;
+            }
+        }
+        template <size_t... I, class Tuple>
+        void construct_row_from(size_type i, Tuple&& t, index_sequence<I...> s) {
+            construct_row(i, s, get<I>(std::forward<Tuple>(t))...);
+        }
+
+        void deallocate() {
+            if (block)
+                data_allocator::deallocate(block, block_bytes(reserved));
+        }
+        // 重新配置为可容纳n个元素的区块，各列搬到新区块
+        void reallocate_storage(size_type n);
+
+    public:
+        soa_vector() : block(0), count(0), reserved(0) {}
+        soa_vector(const soa_vector& x) : data_allocator(x), block(0), count(0), reserved(0) {
+            if (x.count != 0) {
+                block = data_allocator::allocate(block_bytes(x.count));
+                reserved = x.count;
+                columns = layout(block, reserved, indices());
+                try {
+                    copy_columns(x.columns, columns, x.count, indices());
+                }
+                catch(...) {
+                    deallocate();
+                    throw;
+                }
+                count = x.count;
+            }
+        }
+        soa_vector(soa_vector&& x) noexcept
+            : data_allocator(x), block(x.block), columns(x.columns), count(x.count), reserved(x.reserved) {
+            x.block = 0;
+            x.count = x.reserved = 0;
+        }
+        ~soa_vector() {
+            destroy_columns(columns, 0, count, indices());
+            deallocate();
+        }
+
+        soa_vector& operator=(const soa_vector& x) {
+            if (this != &x) {
+                soa_vector tmp(x);
+                swap(tmp);
+            }
+            return *this;
+        }
+        soa_vector& operator=(soa_vector&& x) noexcept {
+            swap(x);
+            return *this;
+        }
+
+        void swap(soa_vector& x) {
+            std::swap((data_allocator&)*this, (data_allocator&)x);
+            std::swap(block, x.block);
+            std::swap(columns, x.columns);
+            std::swap(count, x.count);
+            std::swap(reserved, x.reserved);
+        }
+
+        iterator begin() { return iterator(columns, 0); }
+        const_iterator begin() const { return const_iterator(columns, 0); }
+        iterator end() { return iterator(columns, count); }
+        const_iterator end() const { return const_iterator(columns, count); }
+
+        reverse_iterator rbegin() { return reverse_iterator(end()); }
+        const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+        reverse_iterator rend() { return reverse_iterator(begin()); }
+        const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+        size_type size() const { return count; }
+        size_type capacity() const { return reserved; }
+        bool empty() const { return count == 0; }
+
+        reference operator[](size_type n) { return *(begin() + n); }
+        const_reference operator[](size_type n) const { return *(begin() + n); }
+        reference front() { return *begin(); }
+        const_reference front() const { return *begin(); }
+        reference back() { return *(end() - 1); }
+        const_reference back() const { return *(end() - 1); }
+
+        // 第I列的起点，元素连续存放，共size()个
+        template <size_t I>
+        field_type<I>* column() { return get<I>(columns); }
+        template <size_t I>
+        const field_type<I>* column() const { return get<I>(columns); }
+
+        void reserve(size_type n) {
+            if (reserved < n)
+                reallocate_storage(n);
+        }
+
+        // 以各字段的值新增一个元素
+        void push_back(const Fields&... xs) {
+            if (count == reserved) {
+                value_type x_copy(xs...);      // 参数可能正引用soa_vector中的元素
+                reallocate_storage(count != 0 ? 2 * count : 1);
+                construct_row_from(count, std::move(x_copy), indices());
+            }
+            else
+                construct_row(count, indices(), xs...);
+            ++count;
+        }
+        void push_back(const value_type& x) {
+            if (count == reserved) {
+                value_type x_copy(x);
+                reallocate_storage(count != 0 ? 2 * count : 1);
+                construct_row_from(count, std::move(x_copy), indices());
+            }
+            else
+                construct_row_from(count, x, indices());
+            ++count;
+        }
+        void pop_back() {
+            --count;
+            destroy_columns(columns, count, count + 1, indices());
+        }
+
+        // 元素个数改为n，新增元素为值初始化
+        void resize(size_type n) {
+            if (n < count) {
+                destroy_columns(columns, n, count, indices());
+                count = n;
+            }
+            else {
+                reserve(n);
+                for ( ; count < n; ++count)
+                    construct_row(count, indices(), Fields()...);
+            }
+        }
+        void clear() {
+            destroy_columns(columns, 0, count, indices());
+            count = 0;
+        }
+};
+
+template <class... Fields>
+void soa_vector<Fields...>::reallocate_storage(size_type n)
+{
+    char* new_block = data_allocator::allocate(block_bytes(n));
+    column_pointers new_columns = layout(new_block, n, indices());
+    try {
+        move_columns(columns, new_columns, count, indices());
+    }
+    catch(...) {
+        data_allocator::deallocate(new_block, block_bytes(n));
+        throw;
+    }
+    destroy_columns(columns, 0, count, indices());
+    deallocate();
+    block = new_block;
+    columns = new_columns;
+    reserved = n;
+}
+
+template <class... Fields>
+inline bool operator==(const soa_vector<Fields...>& x, const soa_vector<Fields...>& y) {
+    return x.size() == y.size() && std::equal(x.begin(), x.end(), y.begin());
+}
+
+template <class... Fields>
+inline bool operator!=(const soa_vector<Fields...>& x, const soa_vector<Fields...>& y) {
+    return !(x == y);
+}
+
+#endif
@@ -27,7 +27,8 @@ class stack {
         size_type size() const { return c.size(); }
         reference top() { return c.back(); }
         const_reference top() const { return c.back(); }
-        void push(const value_type &x) { c.push_back(x); }
+        // 底层容器的push_back若传回结果(如static_vector已满时传回false)，原样传回
+        auto push(const value_type &x) -> decltype(c.push_back(x)) { return c.push_back(x); }
         void pop() { c.pop_back(); }
 };
 
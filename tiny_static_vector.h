@@ -0,0 +1,259 @@
+#ifndef __TINY_STATIC_VECTOR_H
+#define __TINY_STATIC_VECTOR_H
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include "tiny_construct.h"
+
+// 容量固定为N的vector：元素全部放在对象本身之内，没有配置器，永远不配置空间
+// 迭代器是普通指针，元素连续存放
+// 空间已满时不扩充：push_back、emplace_back、insert与resize不做任何改动并传回false，
+// 成功时传回true；构造函数无法传回结果，元素超过N个时抛出length_error
+// 可作为stack的底层容器，stack::push会把push_back的结果传回
+template <class T, size_t N>
+class static_vector {
+    public:
+        typedef T value_type;
+        typedef value_type *pointer;
+        typedef const value_type* const_pointer;
+        typedef value_type *iterator;
+        typedef const value_type* const_iterator;
+        typedef value_type &reference;
+        typedef const value_type& const_reference;
+        typedef size_t size_type;
+        typedef ptrdiff_t difference_type;
+
+        typedef reverse_iterator<const_iterator> const_reverse_iterator;
+        typedef reverse_iterator<iterator> reverse_iterator;
+
+    protected:
+        // 以元素个数而非尾端指针记录大小，static_vector本身不含指向自己的指针
+        size_type count;
+        // N为0时仍保留一个元素大小，以免数组长度为0
+        alignas(T) unsigned char buffer[sizeof(T) * (N != 0 ? N : 1)];
+
+        iterator start() { return (iterator)(void*)buffer; }
+        const_iterator start() const { return (const_iterator)(const void*)buffer; }
+        static void check_length(size_type n) {
+            if (n > N)
+                throw length_error("static_vector");
+        }
+
+    public:
+        iterator begin() { return start(); }
+        const_iterator begin() const { return start(); }
+
+        iterator end() { return start() + count; }
+        const_iterator end() const { return start() + count; }
+
+        reverse_iterator rbegin() { return reverse_iterator(end()); }
+        const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+
+        reverse_iterator rend() { return reverse_iterator(begin()); }
+        const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+        pointer data() { return start(); }
+        const_pointer data() const { return start(); }
+
+        size_type size() const { return count; }
+        static size_type max_size() { return N; }
+        static size_type capacity() { return N; }
+        bool empty() const { return count == 0; }
+        bool full() const { return count == N; }
+
+        const_reference operator[](size_type n) const { return *(begin() + n); }
+        reference operator[](size_type n) { return *(begin() + n); }
+
+        reference at(size_type n) { return (*this)[n]; }
+        const_reference at(size_type n) const { return (*this)[n]; }
+
+        reference front() { return *begin(); }
+        const_reference front() const { return *begin(); }
+        reference back() { return *(end() - 1); }
+        const_reference back() const { return *(end() - 1); }
+
+    public:
+        static_vector() : count(0) {}
+        explicit static_vector(size_type n) : count(0) {
+            check_length(n);
+            Construct_n(start(), n);
+            count = n;
+        }
+        static_vector(size_type n, const T& value) : count(0) {
+            check_length(n);
+            Uninitialized_fill_n(start(), n, value);
+            count = n;
+        }
+        static_vector(const T* first, const T* last) : count(0) {
+            check_length(last - first);
+            Uninitialized_copy(first, last, start());
+            count = last - first;
+        }
+        static_vector(const static_vector& x) : count(0) {
+            Uninitialized_copy(x.begin(), x.end(), start());
+            count = x.count;
+        }
+        // 元素只能逐一搬移，x保留搬移后的元素
+        static_vector(static_vector&& x) noexcept(is_nothrow_move_constructible<T>::value)
+            : count(0) {
+            Uninitialized_move_if_noexcept(x.begin(), x.end(), start());
+            count = x.count;
+        }
+
+        ~static_vector() { Destroy(begin(), end()); }
+
+        static_vector& operator=(const static_vector& x) {
+            if (&x != this) {
+                if (count >= x.count) {
+                    iterator i = copy(x.begin(), x.end(), begin());
+                    Destroy(i, end());
+                }
+                else {
+                    copy(x.begin(), x.begin() + count, begin());
+                    Uninitialized_copy(x.begin() + count, x.end(), end());
+                }
+                count = x.count;
+            }
+            return *this;
+        }
+        static_vector& operator=(static_vector&& x) noexcept(is_nothrow_move_assignable<T>::value &&
+                                                             is_nothrow_move_constructible<T>::value) {
+            if (&x != this) {
+                if (count >= x.count) {
+                    iterator i = std::move(x.begin(), x.end(), begin());
+                    Destroy(i, end());
+                }
+                else {
+                    std::move(x.begin(), x.begin() + count, begin());
+                    Uninitialized_move_if_noexcept(x.begin() + count, x.end(), end());
+                }
+                count = x.count;
+            }
+            return *this;
+        }
+
+        bool push_back(const T& x) {
+            if (full())
+                return false;
+            Construct(end(), x);
+            ++count;
+            return true;
+        }
+        bool push_back(T&& x) { return emplace_back(std::move(x)); }
+        template <class... Args>
+        bool emplace_back(Args&&... args) {
+            if (full())
+                return false;
+            Construct(end(), std::forward<Args>(args)...);
+            ++count;
+            return true;
+        }
+
+        void pop_back() {
+            --count;
+            Destroy(end());
+        }
+
+        iterator erase(iterator position) {
+            if (position + 1 != end())
+                std::move(position + 1, end(), position);
+            pop_back();
+            return position;
+        }
+        iterator erase(iterator first, iterator last) {
+            iterator i = std::move(last, end(), first);
+            Destroy(i, end());
+            count = i - begin();
+            return first;
+        }
+
+        bool insert(iterator position, const T& x) { return insert(position, 1, x); }
+        bool insert(iterator position, size_type n, const T& x);
+
+        bool resize(size_type new_size, const T& x) {
+            if (new_size < size()) {
+                erase(begin() + new_size, end());
+                return true;
+            }
+            return insert(end(), new_size - size(), x);
+        }
+        bool resize(size_type new_size) { return resize(new_size, T()); }
+        void clear() { erase(begin(), end()); }
+
+        // 逐一交换元素，较长一方多出的元素搬到较短一方
+        void swap(static_vector& x) {
+            static_vector& s = count < x.count ? *this : x;
+            static_vector& l = count < x.count ? x : *this;
+            const size_type n = s.count;
+            std::swap_ranges(s.begin(), s.end(), l.begin());
+            Uninitialized_move_if_noexcept(l.begin() + n, l.end(), s.end());
+            s.count = l.count;
+            Destroy(l.begin() + n, l.end());
+            l.count = n;
+        }
+};
+
+// 从position开始，插入n个元素，元素初值为x；剩余空间不足n个时不做任何改动
+template <class T, size_t N>
+bool static_vector<T, N>::insert(iterator position, size_type n, const T& x)
+{
+    if (n > N - count)
+        return false;
+    if (n == 0)
+        return true;
+    T x_copy = x;       // x可能正是static_vector中的元素
+    const size_type elems_after = end() - position;
+    iterator old_finish = end();
+    if (elems_after > n) {
+        Uninitialized_move_if_noexcept(old_finish - n, old_finish, old_finish);
+        count += n;
+        std::move_backward(position, old_finish - n, old_finish);
+        fill(position, position + n, x_copy);
+    }
+    else {
+        Uninitialized_fill_n(old_finish, n - elems_after, x_copy);
+        count += n - elems_after;
+        Uninitialized_move_if_noexcept(position, old_finish, end());
+        count += elems_after;
+        fill(position, old_finish, x_copy);
+    }
+    return true;
+}
+
+template <class T, size_t N>
+inline bool operator==(const static_vector<T, N>& x, const static_vector<T, N>& y) {
+    return x.size() == y.size() && equal(x.begin(), x.end(), y.begin());
+}
+
+template <class T, size_t N>
+inline bool operator<(const static_vector<T, N>& x, const static_vector<T, N>& y) {
+    return lexicographical_compare(x.begin(), x.end(), y.begin(), y.end());
+}
+
+template <class T, size_t N>
+inline bool operator!=(const static_vector<T, N>& x, const static_vector<T, N>& y) {
+    return !(x == y);
+}
+
+template <class T, size_t N>
+inline bool operator>(const static_vector<T, N>& x, const static_vector<T, N>& y) {
+    return y < x;
+}
+
+template <class T, size_t N>
+inline bool operator<=(const static_vector<T, N>& x, const static_vector<T, N>& y) {
+    return !(y < x);
+}
+
+template <class T, size_t N>
+inline bool operator>=(const static_vector<T, N>& x, const static_vector<T, N>& y) {
+    return !(x < y);
+}
+
+// static_vector只含元素个数与元素本身，元素可逐位搬家时整个static_vector亦然
+template <class T, size_t N>
+struct is_trivially_relocatable<static_vector<T, N> > : is_trivially_relocatable<T> {};
+
+#endif
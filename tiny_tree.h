@@ -157,13 +157,14 @@ inline Value* value_type(const __rb_tree_iterator<Value, Ref, Ptr>&) {
   return (Value*) 0;
 }
 
-template <class Key,class Value,class KeyOfValue,class Compare>
-class rb_tree {
+template <class Key,class Value,class KeyOfValue,class Compare,class Alloc = alloc>
+class rb_tree : protected simple_alloc<__rb_tree_node<Value>, Alloc> {
     protected:
         typedef void *void_pointer;
         typedef __rb_tree_node_base *base_ptr;
         typedef __rb_tree_node<Value> rb_tree_node;
-        typedef simple_alloc<rb_tree_node> rb_tree_node_allocator;
+        // rb_tree继承节点配置器以保存Alloc
+        typedef simple_alloc<rb_tree_node, Alloc> rb_tree_node_allocator;
         typedef __rb_tree_color_type color_type;
     
     public:
@@ -176,6 +177,9 @@ class rb_tree {
         typedef rb_tree_node *link_type;
         typedef size_t size_type;
         typedef ptrdiff_t difference_type;
+        typedef Alloc allocator_type;
+
+        allocator_type get_allocator() const { return rb_tree_node_allocator::get_allocator(); }
 
     protected:
         link_type get_node() { return rb_tree_node_allocator::allocate(); }
@@ -275,6 +279,7 @@ class rb_tree {
         iterator __insert(base_ptr x, base_ptr y, const value_type &v);
         link_type __copy(link_type x, link_type p);
         void __erase(link_type x);
+        void __erase_aux(link_type x, bool release);
         void init() {
             header = get_node();            // 产生一个节点空间，令header指向它
             color(header) = __rb_tree_red;  // 令header为红色，用来区分header
@@ -286,13 +291,14 @@ class rb_tree {
 
     public:
         // allocation/deallocation
-        rb_tree(const Compare &comp = Compare()) : node_count(0), key_compare(comp) { init(); }
+        rb_tree(const Compare &comp = Compare(), const allocator_type& a = allocator_type())
+            : rb_tree_node_allocator(a), node_count(0), key_compare(comp) { init(); }
 
         ~rb_tree() {
             clear();
             put_node(header);
         }
-        rb_tree<Key, Value, KeyOfValue, Compare> &operator=(const rb_tree<Key, Value, KeyOfValue, Compare> &x);
+        rb_tree<Key, Value, KeyOfValue, Compare, Alloc> &operator=(const rb_tree<Key, Value, KeyOfValue, Compare, Alloc> &x);
 
     public:
         // accessors
@@ -313,7 +319,9 @@ class rb_tree {
         size_type size() const { return node_count; }
         size_type max_size() const { return size_type(-1); }
 
-        void swap(rb_tree<Key, Value, KeyOfValue, Compare> &t) {
+        // 配置器随header一起交换
+        void swap(rb_tree<Key, Value, KeyOfValue, Compare, Alloc> &t) {
+            std::swap((rb_tree_node_allocator&)*this, (rb_tree_node_allocator&)t);
             std::swap(header, t.header);
             std::swap(node_count, t.node_count);
             std::swap(key_compare, t.key_compare);
@@ -364,9 +372,9 @@ class rb_tree {
 
 };
 
-template <class Key, class Value, class KeyOfValue, class Compare>
-rb_tree<Key,Value,KeyOfValue,Compare>& 
-rb_tree<Key,Value,KeyOfValue,Compare>::operator=(const rb_tree<Key,Value,KeyOfValue,Compare>& x)
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+rb_tree<Key, Value, KeyOfValue, Compare, Alloc>& 
+rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::operator=(const rb_tree<Key, Value, KeyOfValue, Compare, Alloc>& x)
 {
     if (this != &x) {
                                     // Note that _Key may be a constant type.
@@ -390,9 +398,9 @@ rb_tree<Key,Value,KeyOfValue,Compare>::operator=(const rb_tree<Key,Value,KeyOfVa
 
 // 插入新值：节点键值允许重复
 // 注意，返回值是一个RB-tree迭代器，指向新增节点
-template <class Key, class Value, class KeyOfValue, class Compare>
-typename rb_tree<Key, Value, KeyOfValue, Compare>::iterator
-rb_tree<Key,Value,KeyOfValue,Compare>::insert_equal(const Value& v)
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::iterator
+rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::insert_equal(const Value& v)
 {
     link_type y = header;
     link_type x = root();       // 从根节点开始
@@ -408,9 +416,9 @@ rb_tree<Key,Value,KeyOfValue,Compare>::insert_equal(const Value& v)
 // 插入新值：节点键值不允许重复，若重复则插入无效
 // 注意，返回值是个pair，第一个元素是个RB-tree迭代器，指向新增节点
 // 第二叉素表示插入成功与否
-template <class Key,class Value,class KeyOfValue,class Compare>
-pair<typename rb_tree<Key,Value,KeyOfValue,Compare>::iterator,bool>
-rb_tree<Key,Value,KeyOfValue,Compare>::insert_unique(const Value& v) {
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+pair<typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::iterator,bool>
+rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::insert_unique(const Value& v) {
     link_type y = header;
     link_type x = root();       // 从根结点开始
     bool comp = true;
@@ -438,9 +446,9 @@ rb_tree<Key,Value,KeyOfValue,Compare>::insert_unique(const Value& v) {
     return pair<iterator, bool>(j, false);
 }
 
-template <class Key,class Value,class KeyOfValue,class Compare>
-typename rb_tree<Key,Value,KeyOfValue,Compare>::iterator
-rb_tree<Key,Value,KeyOfValue,Compare>::
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::iterator
+rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::
 __insert(base_ptr x_,base_ptr y_,const Value& v) {
     // 参数x_为新值插入点，参数y_为插入点之父节点，参数v为新值
     link_type x = (link_type)x_;
@@ -705,19 +713,32 @@ rb_tree_rebalance_for_erase(__rb_tree_node_base *z, __rb_tree_node_base *&root,
 
 
 // 内部的删除函数
-template <class Key, class Value, class KeyOfValue, class Compare>
-void rb_tree<Key,Value,KeyOfValue,Compare>::__erase(link_type x)
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+void rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::__erase(link_type x)
+{
+    // 配置器的释放为空操作(如monotonic_buffer_resource)时不必逐一归还节点
+    // 若元素又无需析构，整棵子树连走访都可省去，空间由资源整体释放
+    bool release = !rb_tree_node_allocator::deallocate_is_noop();
+    if (release || !__type_traits<Value>::has_trivial_destructor::value)
+        __erase_aux(x, release);
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+void rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::__erase_aux(link_type x, bool release)
 {
     while (x != 0) {
-        __erase(right(x));
+        __erase_aux(right(x), release);
         link_type y = left(x);
-        destroy_node(x);
+        if (release)
+            destroy_node(x);
+        else
+            Destroy(&x->value_filed);
         x = y;
     }
 }
 
-template <class Key, class Value, class KeyOfValue, class Compare>
-inline void rb_tree<Key,Value,KeyOfValue,Compare>::erase(iterator position)
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+inline void rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::erase(iterator position)
 {
     link_type y =
         (link_type)rb_tree_rebalance_for_erase(position.node, header->parent,
@@ -727,9 +748,9 @@ inline void rb_tree<Key,Value,KeyOfValue,Compare>::erase(iterator position)
 }
 
 // 删除键值为key的节点
-template <class Key, class Value, class KeyOfValue, class Compare>
-typename rb_tree<Key,Value,KeyOfValue,Compare>::size_type 
-rb_tree<Key,Value,KeyOfValue,Compare>::erase(const Key& x)
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::size_type 
+rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::erase(const Key& x)
 {
   pair<iterator,iterator> p = equal_range(x);
   size_type n = 0;
@@ -739,8 +760,8 @@ rb_tree<Key,Value,KeyOfValue,Compare>::erase(const Key& x)
 }
 
 // 删除指针范围内的节点
-template <class Key, class Value, class KeyOfValue, class Compare>
-void rb_tree<Key,Value,KeyOfValue,Compare>::erase(iterator first, iterator last) {
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+void rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::erase(iterator first, iterator last) {
     if (first == begin() && last == end())
         clear();
     else
@@ -748,14 +769,14 @@ void rb_tree<Key,Value,KeyOfValue,Compare>::erase(iterator first, iterator last)
 }
 
 // 删除一定数值范围内的节点
-template <class Key, class Value, class KeyOfValue, class Compare>
-void rb_tree<Key,Value,KeyOfValue,Compare>::erase(const Key* first, const Key* last) {
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+void rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::erase(const Key* first, const Key* last) {
     while (first != last) erase(*first++);
 }
 
-template <class Key, class Value, class KeyOfValue, class Compare>
-typename rb_tree<Key, Value, KeyOfValue, Compare>::iterator 
-rb_tree<Key, Value, KeyOfValue, Compare>::insert_unique(iterator position, const Value& v)
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::iterator 
+rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::insert_unique(iterator position, const Value& v)
 {
     if (position.node == header->left) { // begin()
         if (size() > 0 && 
@@ -784,9 +805,9 @@ rb_tree<Key, Value, KeyOfValue, Compare>::insert_unique(iterator position, const
     }
 }
 
-template <class Key, class Value, class KeyOfValue, class Compare>
-typename rb_tree<Key,Value,KeyOfValue,Compare>::iterator 
-rb_tree<Key,Value,KeyOfValue,Compare>::insert_equal(iterator position, const Value& v)
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::iterator 
+rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::insert_equal(iterator position, const Value& v)
 {
     if (position.node == header->left) { // begin()
         if (size() > 0 && 
@@ -816,9 +837,9 @@ rb_tree<Key,Value,KeyOfValue,Compare>::insert_equal(iterator position, const Val
     }
 }
 
-template <class Key, class Value, class KeyOfValue, class Compare>
-typename rb_tree<Key,Value,KeyOfValue,Compare>::iterator 
-rb_tree<Key,Value,KeyOfValue,Compare>::find(const Key& k)
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::iterator 
+rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::find(const Key& k)
 {
     link_type y = header;
     link_type x = root();
@@ -836,9 +857,9 @@ rb_tree<Key,Value,KeyOfValue,Compare>::find(const Key& k)
     return (j == end() || key_compare(k, key(j.node))) ? end() : j;
 }
 
-template <class Key, class Value, class KeyOfValue, class Compare>
-typename rb_tree<Key,Value,KeyOfValue,Compare>::const_iterator 
-rb_tree<Key,Value,KeyOfValue,Compare>::find(const Key& k) const
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::const_iterator 
+rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::find(const Key& k) const
 {
     link_type y = header; /* Last node which is not less than __k. */
     link_type x = root(); /* Current node. */
@@ -853,9 +874,9 @@ rb_tree<Key,Value,KeyOfValue,Compare>::find(const Key& k) const
     return (j == end() || key_compare(k, key(j.node))) ? end() : j;
 }
 
-template <class Key, class Value, class KeyOfValue, class Compare>
-typename rb_tree<Key,Value,KeyOfValue,Compare>::size_type 
-rb_tree<Key,Value,KeyOfValue,Compare>::count(const Key& k) const
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::size_type 
+rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::count(const Key& k) const
 {
     pair<const_iterator, const_iterator> p = equal_range(k);
     size_type n = 0;
@@ -863,9 +884,9 @@ rb_tree<Key,Value,KeyOfValue,Compare>::count(const Key& k) const
     return n;
 }
 
-template <class Key, class Value, class KeyOfValue, class Compare>
-typename rb_tree<Key,Value,KeyOfValue,Compare>::iterator 
-rb_tree<Key,Value,KeyOfValue,Compare>::lower_bound(const Key& k)
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::iterator 
+rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::lower_bound(const Key& k)
 {
     link_type y = header; /* Last node which is not less than __k. */
     link_type x = root(); /* Current node. */
@@ -879,9 +900,9 @@ rb_tree<Key,Value,KeyOfValue,Compare>::lower_bound(const Key& k)
     return iterator(y);
 }
 
-template <class Key, class Value, class KeyOfValue, class Compare>
-typename rb_tree<Key,Value,KeyOfValue,Compare>::const_iterator 
-rb_tree<Key,Value,KeyOfValue,Compare>::lower_bound(const Key& k) const
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::const_iterator 
+rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::lower_bound(const Key& k) const
 {
     link_type y = header; /* Last node which is not less than __k. */
     link_type x = root(); /* Current node. */
@@ -895,9 +916,9 @@ rb_tree<Key,Value,KeyOfValue,Compare>::lower_bound(const Key& k) const
     return const_iterator(y);
 }
 
-template <class Key, class Value, class KeyOfValue, class Compare>
-typename rb_tree<Key,Value,KeyOfValue,Compare>::iterator 
-rb_tree<Key,Value,KeyOfValue,Compare>::upper_bound(const Key& k)
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::iterator 
+rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::upper_bound(const Key& k)
 {
     link_type y = header; /* Last node which is greater than __k. */
     link_type x = root(); /* Current node. */
@@ -911,9 +932,9 @@ rb_tree<Key,Value,KeyOfValue,Compare>::upper_bound(const Key& k)
     return iterator(y);
 }
 
-template <class Key, class Value, class KeyOfValue, class Compare>
-typename rb_tree<Key,Value,KeyOfValue,Compare>::const_iterator 
-rb_tree<Key,Value,KeyOfValue,Compare>::upper_bound(const Key& k) const
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::const_iterator 
+rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::upper_bound(const Key& k) const
 {
     link_type y = header; /* Last node which is greater than __k. */
     link_type x = root(); /* Current node. */
@@ -927,34 +948,34 @@ rb_tree<Key,Value,KeyOfValue,Compare>::upper_bound(const Key& k) const
     return const_iterator(y);
 }
 
-template <class Key, class Value, class KeyOfValue, class Compare>
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
 inline 
-pair<typename rb_tree<Key,Value,KeyOfValue,Compare>::iterator,
-     typename rb_tree<Key,Value,KeyOfValue,Compare>::iterator>
-rb_tree<Key,Value,KeyOfValue,Compare>::equal_range(const Key& k)
+pair<typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::iterator,
+     typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::iterator>
+rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::equal_range(const Key& k)
 {
     return pair<iterator, iterator>(lower_bound(k), upper_bound(k));
 }
 
-template <class Key, class Value, class KeyOfValue, class Compare>
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
 inline 
-pair<typename rb_tree<Key, Value, KeyOfValue, Compare>::const_iterator,
-     typename rb_tree<Key, Value, KeyOfValue, Compare>::const_iterator>
-rb_tree<Key, Value, KeyOfValue, Compare>::equal_range(const Key& k) const
+pair<typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::const_iterator,
+     typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::const_iterator>
+rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::equal_range(const Key& k) const
 {
     return pair<const_iterator, const_iterator>(lower_bound(k), upper_bound(k));
 }
 
-template <class Key, class Value, class KeyOfValue, class Compare>
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
 template <class InputIterator>
-void rb_tree<Key, Value, KeyOfValue, Compare>::insert_equal(InputIterator first, InputIterator last) {
+void rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::insert_equal(InputIterator first, InputIterator last) {
   for ( ; first != last; ++first)
     insert_equal(*first);
 }
 
-template <class Key, class Value, class KeyOfValue, class Compare>
+template <class Key, class Value, class KeyOfValue, class Compare, class Alloc>
 template <class InputIterator>
-void rb_tree<Key, Value, KeyOfValue, Compare>::insert_unique(InputIterator first, InputIterator last) {
+void rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::insert_unique(InputIterator first, InputIterator last) {
   for ( ; first != last; ++first)
     insert_unique(*first);
 }
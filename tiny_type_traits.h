@@ -0,0 +1,36 @@
+#ifndef __TINY_TYPE_TRAITS_H
+#define __TINY_TYPE_TRAITS_H
+
+#include <type_traits>
+
+using namespace std;
+
+// 型别特性：供Construct/Destroy与copy等算法判断能否略过构造、析构，
+// 或直接以memcpy/memset处理整个区间
+// 每一项都是true_type或false_type，可作为重载函数的参数进行编译期分派
+// (libstdc++在std中另有__true_type，为免与之冲突，这里直接使用标准的true_type/false_type)
+//
+// 默认值由编译器的型别判断得出；用户可为自己的型别特化__type_traits，
+// 例如声明某个带自定义析构函数、但析构可略过的型别has_trivial_destructor
+template <class T>
+struct __type_traits {
+    typedef integral_constant<bool, is_trivially_default_constructible<T>::value>
+        has_trivial_default_constructor;
+    typedef integral_constant<bool, is_trivially_copy_constructible<T>::value>
+        has_trivial_copy_constructor;
+    typedef integral_constant<bool, is_trivially_copy_assignable<T>::value>
+        has_trivial_assignment_operator;
+    typedef integral_constant<bool, is_trivially_destructible<T>::value>
+        has_trivial_destructor;
+    typedef integral_constant<bool, is_trivial<T>::value && is_standard_layout<T>::value>
+        is_POD_type;
+};
+
+// 元素可否"逐位搬家"：以memcpy把对象搬到新地址并直接丢弃旧的那份，
+// 等同于move construct到新地址再析构旧对象
+// 可逐位复制的型别必然如此；其他不保存指向自身的指针的型别，例如只持有堆上资源的句柄，
+// 也大多如此，用户可为之特化，令vector扩充时以一次memcpy或realloc搬移全部元素
+template <class T>
+struct is_trivially_relocatable : integral_constant<bool, is_trivially_copyable<T>::value> {};
+
+#endif
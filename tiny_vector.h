@@ -4,11 +4,51 @@
 #include <memory>
 #include <algorithm>
 #include <iterator>
+#include <type_traits>
 #include "tiny_alloc.h"
+#include "tiny_memory_resource.h"
 #include "tiny_construct.h"
 
-template <class T>
-class vector {
+// 增长策略：空间不足时决定新容量
+// grow(size, n, elem_size)传回已有size个元素、需要再容纳n个时的新容量，至少size+n
+// vector的第三个模板参数，可依工作负载选用
+
+// 增长为原来的两倍：重新配置的次数最少，但新区块总比之前释放的所有区块加起来还大，
+// 释放的旧区块永远无法留给之后更大的配置重复使用
+struct grow_by_2 {
+    static size_t grow(size_t size, size_t n, size_t) {
+        return size + max(size, n);
+    }
+};
+
+// 增长为原来的1.5倍：重新配置次数较多，但几次之后释放的旧区块加起来足以容纳新区块，
+// 相邻的旧区块若被配置器合并，即可重复使用，峰值内存也较小
+struct grow_by_1_5 {
+    static size_t grow(size_t size, size_t n, size_t) {
+        return size + max(size / 2, n);
+    }
+};
+
+// 按1.5倍增长，区块达到一页以上时再补足到整页
+// 大区块由malloc以mmap按页配置，补足的部分本来就会配置，不如让vector用上
+#ifndef __TINY_GROWTH_PAGE_SIZE
+#define __TINY_GROWTH_PAGE_SIZE ((size_t)4096)
+#endif
+
+struct grow_page_rounded {
+    static size_t grow(size_t size, size_t n, size_t elem_size) {
+        size_t len = grow_by_1_5::grow(size, n, elem_size);
+        size_t bytes = len * elem_size;
+        if (bytes >= __TINY_GROWTH_PAGE_SIZE) {
+            bytes = (bytes + __TINY_GROWTH_PAGE_SIZE - 1) & ~(__TINY_GROWTH_PAGE_SIZE - 1);
+            len = bytes / elem_size;
+        }
+        return len;
+    }
+};
+
+template <class T, class Alloc = alloc, class Growth = grow_by_2>
+class vector : protected simple_alloc<T, Alloc> {
     public:
         typedef T value_type;
         typedef value_type *pointer;
@@ -19,18 +59,33 @@ class vector {
         typedef const value_type& const_reference;
         typedef size_t size_type;
         typedef ptrdiff_t difference_type;
+        typedef Alloc allocator_type;
+        typedef Growth growth_policy;
 
         typedef reverse_iterator<const_iterator> const_reverse_iterator;
         typedef reverse_iterator<iterator> reverse_iterator;
 
     protected:
-        // 以下，simple_alloc是简化版空间配置器
-        typedef simple_alloc<value_type> data_allocator;
+        // 以下，simple_alloc是简化版空间配置器，vector继承它以保存Alloc
+        typedef simple_alloc<value_type, Alloc> data_allocator;
+        // 元素可否逐位搬家，是则重新配置时以memcpy/realloc搬移，旧元素不必逐一析构
+        typedef is_trivially_relocatable<T> relocatable;
         iterator start;     // 表示目前使用空间的头
         iterator finish;    // 表示目前使用空间的尾,指向最后一个元素的下一个位置
         iterator end_of_storage;    // 表示目前可用空间的尾
 
         void insert_aux(iterator position, const T &x);
+        // 空间不足时重新配置，并在position处以args构造新元素
+        template <class... Args>
+        void realloc_insert(iterator position, Args&&... args);
+        // 以memcpy把[first,last)搬到以result起始的未初始化空间，返回尾端
+        // 只用于可逐位搬家的元素，搬完之后原区间视为已析构
+        static iterator relocate(iterator first, iterator last, iterator result) {
+            size_type n = last - first;
+            if (n != 0)
+                memcpy((void*)result, (const void*)first, n * sizeof(T));
+            return result + n;
+        }
         void deallocate() {
             if (start)
                 data_allocator::deallocate(start, end_of_storage - start);
@@ -42,6 +97,8 @@ class vector {
             end_of_storage = finish;
         }
     public:
+        allocator_type get_allocator() const { return data_allocator::get_allocator(); }
+
         iterator begin() { return start; }
         const_iterator begin() const { return start; }
 
@@ -80,28 +137,72 @@ class vector {
     public:
         // 构造函数
         vector():start(0),finish(0),end_of_storage(0) {}
-        vector(size_type n) { fill_initialize(n, T()); }
-        vector(size_type n, const T &value) { fill_initialize(n, value); }
-        vector(int n, const T &value) { fill_initialize(n, value); }
-        vector(long n, const T &value) { fill_initialize(n, T()); }
-        vector(const T* first, const T* last){
-            fill_initialize(1, 0);      // 先分配一个元素的空间
-            finish = uninitialized_copy(first, last, start); 
+        explicit vector(const allocator_type& a)
+            : data_allocator(a), start(0), finish(0), end_of_storage(0) {}
+        vector(size_type n) {
+            // 值初始化n个元素，算术与指针型别以memset一次完成
+            start = data_allocator::allocate(n);
+            try {
+                finish = Construct_n(start, n);
+            }
+            catch(...) {
+                data_allocator::deallocate(start, n);
+                throw;
+            }
+            end_of_storage = finish;
+        }
+        vector(size_type n, const T &value, const allocator_type& a = allocator_type())
+            : data_allocator(a) { fill_initialize(n, value); }
+        vector(int n, const T &value, const allocator_type& a = allocator_type())
+            : data_allocator(a) { fill_initialize(n, value); }
+        vector(long n, const T &value, const allocator_type& a = allocator_type())
+            : data_allocator(a) { fill_initialize(n, value); }
+        // 以[first,last)构造：前向迭代器先求出元素个数，只配置一次；
+        // 输入迭代器只能逐一push_back；两个参数都是整数时视同vector(n, value)
+        template <class InputIterator>
+        vector(InputIterator first, InputIterator last, const allocator_type& a = allocator_type())
+            : data_allocator(a), start(0), finish(0), end_of_storage(0) {
+            initialize_dispatch(first, last, is_integral<InputIterator>());
+        }
+        // 拷贝构造函数，配置器随之复制
+        vector(const vector<T, Alloc, Growth>& x) : data_allocator(x) {
+            start = allocate_and_copy(x.size(), x.begin(), x.end());
+            finish = start + x.size();
+            end_of_storage = finish;
+        }
+        // 移动构造函数，接管x的空间与配置器，x成为空vector
+        vector(vector<T, Alloc, Growth>&& x) noexcept
+            : data_allocator(x), start(x.start), finish(x.finish), end_of_storage(x.end_of_storage) {
+            x.start = x.finish = x.end_of_storage = 0;
         }
 
         // 析构函数
         ~vector() {
             Destroy(start, finish);     // 全局函数
-            //deallocate();
+            deallocate();
         }
 
         // 容器预留空间大小n
         void reserve(size_type n) {
             if (capacity() < n) {
                 const size_type old_size = size();
-                iterator tmp = allocate_and_copy(n, start, finish);
+                if (start != 0 && relocatable::value) {
+                    // 元素可逐位搬家：交给配置器的reallocate()，可能原地扩充
+                    start = data_allocator::reallocate(start, capacity(), n);
+                    finish = start + old_size;
+                    end_of_storage = start + n;
+                    return;
+                }
+                iterator tmp = data_allocator::allocate_at_least(n);   // n改为实际容量
+                try {
+                    Uninitialized_move_if_noexcept(start, finish, tmp);
+                }
+                catch(...) {
+                    data_allocator::deallocate(tmp, n);
+                    throw;
+                }
                 Destroy(start, finish);
-                data_allocator::deallocate(start, end_of_storage - start);
+                deallocate();
                 start = tmp;
                 finish = tmp + old_size;
                 end_of_storage = start + n;
@@ -118,8 +219,21 @@ class vector {
             else
                 insert_aux(end(), x);
         }
+        void push_back(T&& x) { emplace_back(std::move(x)); }
+        // 以args在尾端直接构造元素
+        template <class... Args>
+        void emplace_back(Args&&... args) {
+            if (finish != end_of_storage) {
+                Construct(finish, std::forward<Args>(args)...);
+                ++finish;
+            }
+            else
+                realloc_insert(finish, std::forward<Args>(args)...);
+        }
 
-        void swap(vector<T>& x) {
+        // 配置器随内容一起交换
+        void swap(vector<T, Alloc, Growth>& x) {
+            std::swap((data_allocator&)*this, (data_allocator&)x);
             std::swap(start, x.start);
             std::swap(finish, x.finish);
             std::swap(end_of_storage, x.end_of_storage);
@@ -152,19 +266,86 @@ class vector {
                 insert(end(), new_size - size(), x);
         }
         void resize(size_type new_size) { resize(new_size, T()); }
+        // 与resize相同，但新增元素只做默认初始化：trivial型别的元素不清零，内容未定
+        // 适合随即被read()等覆写的缓冲区，省去一次memset
+        void resize_default_init(size_type new_size) {
+            if (new_size < size())
+                erase(begin() + new_size, end());
+            else {
+                reserve_for_append(new_size - size());
+                default_initialize(finish, start + new_size,
+                    integral_constant<bool, is_trivially_default_constructible<T>::value>());
+                finish = start + new_size;
+            }
+        }
+        // 确保尾端之后至少有n个元素的备用空间，传回指向备用空间起点的指针，size()不变
+        // 调用者在其中写入(或构造)元素之后，以commit_append(m)把前m个纳入vector，m不可超过n
+        // 期间若再插入元素或重新配置，传回的指针即失效
+        pointer append_uninitialized(size_type n) {
+            reserve_for_append(n);
+            return finish;
+        }
+        void commit_append(size_type n) { finish += n; }
         void clear() { erase(begin(), end()); }
         // 插入元素
         void insert(iterator position, size_type n, const T &x);
         void insert(iterator position, const T &x) { insert_aux(position, x); }
+        // 插入[first,last)：前向迭代器先求出元素个数，空间不足时只重新配置一次
+        template <class InputIterator>
+        void insert(iterator position, InputIterator first, InputIterator last) {
+            insert_dispatch(position, first, last, is_integral<InputIterator>());
+        }
         void insert_aux(iterator position);
-        vector<T> &operator=(const vector<T> &x);
+        // 以n个x或[first,last)取代原有内容，空间不足时只配置一次
+        void assign(size_type n, const T& x);
+        template <class InputIterator>
+        void assign(InputIterator first, InputIterator last) {
+            assign_dispatch(first, last, is_integral<InputIterator>());
+        }
+        vector<T, Alloc, Growth> &operator=(const vector<T, Alloc, Growth> &x);
+        // 移动赋值，释放自己的元素后接管x的空间与配置器
+        vector<T, Alloc, Growth> &operator=(vector<T, Alloc, Growth> &&x) noexcept {
+            if (&x != this) {
+                Destroy(start, finish);
+                deallocate();
+                (data_allocator&)*this = (data_allocator&)x;
+                start = x.start;
+                finish = x.finish;
+                end_of_storage = x.end_of_storage;
+                x.start = x.finish = x.end_of_storage = 0;
+            }
+            return *this;
+        }
 
     protected:
+        // 备用空间不足n个时，依增长策略扩充
+        void reserve_for_append(size_type n) {
+            if (size_type(end_of_storage - finish) < n)
+                reserve(Growth::grow(size(), n, sizeof(T)));
+        }
+        static void default_initialize(iterator, iterator, true_type) {}
+        static void default_initialize(iterator first, iterator last, false_type) {
+            iterator cur = first;
+            try {
+                for ( ; cur != last; ++cur)
+                    new ((void*)cur) T;
+            }
+            catch(...) {
+                Destroy(first, cur);
+                throw;
+            }
+        }
         // 配置而后填充
         iterator allocate_and_fill(size_type n,const T& x) {
             iterator result = data_allocator::allocate(n);      // 配置n个元素空间
-            uninitialized_fill_n(result, n, x);     //全局函数
-            return result;
+            try {
+                Uninitialized_fill_n(result, n, x);     //全局函数
+                return result;
+            }
+            catch(...) {
+                data_allocator::deallocate(result, n);
+                throw;
+            }
         }
         // 配置而后复制
         template <class ForwardIterator>
@@ -172,102 +353,196 @@ class vector {
         {
             iterator result = data_allocator::allocate(n);
             try {
-                uninitialized_copy(first, last, result);
+                Uninitialized_copy(first, last, result);
                 return result;
             }
-            catch(const std::exception& e) {
+            catch(...) {
                 data_allocator::deallocate(result, n);
-                return result;
+                throw;
             }
         }
+        // new_start起始、可容纳len个元素的新空间里，[new_start+(position-start), +n)已构造好新元素
+        // 把原有元素以插入点为界搬到新元素前后，然后释放原空间，改用新空间
+        // 搬移中途抛出异常时析构新元素、释放新空间，原vector不变
+        void adopt_storage(iterator position, iterator new_start, size_type len, size_type n);
+
+        // 整数参数视同n个value，其余依迭代器种类分派
+        template <class Integer>
+        void initialize_dispatch(Integer n, Integer value, true_type) {
+            fill_initialize(n, value);
+        }
+        template <class InputIterator>
+        void initialize_dispatch(InputIterator first, InputIterator last, false_type) {
+            range_initialize(first, last, typename iterator_traits<InputIterator>::iterator_category());
+        }
+        template <class InputIterator>
+        void range_initialize(InputIterator first, InputIterator last, input_iterator_tag) {
+            try {
+                for ( ; first != last; ++first)
+                    push_back(*first);
+            }
+            catch(...) {
+                Destroy(start, finish);
+                deallocate();
+                throw;
+            }
+        }
+        template <class ForwardIterator>
+        void range_initialize(ForwardIterator first, ForwardIterator last, forward_iterator_tag) {
+            size_type n = distance(first, last);
+            start = allocate_and_copy(n, first, last);
+            finish = start + n;
+            end_of_storage = finish;
+        }
+
+        template <class Integer>
+        void insert_dispatch(iterator position, Integer n, Integer x, true_type) {
+            insert(position, (size_type)n, (T)x);
+        }
+        template <class InputIterator>
+        void insert_dispatch(iterator position, InputIterator first, InputIterator last, false_type) {
+            range_insert(position, first, last, typename iterator_traits<InputIterator>::iterator_category());
+        }
+        template <class InputIterator>
+        void range_insert(iterator position, InputIterator first, InputIterator last, input_iterator_tag);
+        template <class ForwardIterator>
+        void range_insert(iterator position, ForwardIterator first, ForwardIterator last, forward_iterator_tag);
+
+        template <class Integer>
+        void assign_dispatch(Integer n, Integer x, true_type) {
+            assign((size_type)n, (T)x);
+        }
+        template <class InputIterator>
+        void assign_dispatch(InputIterator first, InputIterator last, false_type) {
+            range_assign(first, last, typename iterator_traits<InputIterator>::iterator_category());
+        }
+        template <class InputIterator>
+        void range_assign(InputIterator first, InputIterator last, input_iterator_tag);
+        template <class ForwardIterator>
+        void range_assign(ForwardIterator first, ForwardIterator last, forward_iterator_tag);
 };
 
 // 从position开始，插入一个元素，元素初值为x
-template <class T>
-void vector<T>::insert_aux(iterator position,const T& x) {
-    // 在备用空间起始处构造一个元素，并以vector最后一个元素值为其初值
-    if(finish != end_of_storage) {
-        Construct(finish, *(finish - 1));
+template <class T, class Alloc, class Growth>
+void vector<T, Alloc, Growth>::insert_aux(iterator position,const T& x) {
+    if (finish != end_of_storage && position == finish) {
+        // 插入点就是尾端：直接在备用空间构造，没有元素需要后移
+        Construct(finish, x);
+        ++finish;
+    }
+    // 在备用空间起始处构造一个元素，并以vector最后一个元素为其初值(搬移而来)
+    else if(finish != end_of_storage) {
+        Construct(finish, std::move(*(finish - 1)));
         // 调整位置
         ++finish;
         T x_copy = x;
-        copy_backward(position, finish - 2, finish - 1);
-        *position = x_copy;
-    }
-    else {      // 已无备用空间
-        const size_type old_size = size();
-        const size_type len = old_size != 0 ? 2 * old_size : 1;
-        // 以上配置原则：如果原大小为0，则配置1个
-        // 如果原大小不为0，则配置原大小的两倍
-        // 前半段用来放置原数据，后半段准备用来放置新数据
-
-        iterator new_start = data_allocator::allocate(len);     // 实际配置
-        iterator new_finish = new_start;
-        try
-        {
-            // 将原vector的内容拷贝到新vector
-            new_finish = uninitialized_copy(start, position, new_start);
-            // 为新元素设定初值x
-            Construct(new_finish, x);
-            // 调整位置
-            ++new_finish;
-            // 将安插点的原内容也拷贝过来
-            new_finish = uninitialized_copy(position, finish, new_finish);
-        }
-        catch(const std::exception& e)
-        {
-            // commit or rollback semantics
-            Destroy(new_start, new_finish);
-            data_allocator::deallocate(new_start, len);
-            throw;
-        }
-        
-        // 析构并释放原vector
-        Destroy(begin(), end());
-        deallocate();
-
-        // 调整迭代器，指向新的vector
-        start = new_start;
-        finish = new_finish;
-        end_of_storage = new_start + len;
+        std::move_backward(position, finish - 2, finish - 1);
+        *position = std::move(x_copy);
     }
+    else        // 已无备用空间
+        realloc_insert(position, x);
 }
+
 // 从position开始，插入一个元素，使用默认初值
-template <class T>
-void vector<T>::insert_aux(iterator position)
+template <class T, class Alloc, class Growth>
+void vector<T, Alloc, Growth>::insert_aux(iterator position)
 {
-    if (finish != end_of_storage) {
-        construct(finish, *(finish - 1));
+    if (finish != end_of_storage && position == finish) {
+        Construct(finish);
         ++finish;
-        copy_backward(position, finish - 2, finish - 1);
+    }
+    else if (finish != end_of_storage) {
+        Construct(finish, std::move(*(finish - 1)));
+        ++finish;
+        std::move_backward(position, finish - 2, finish - 1);
         *position = T();
     }
+    else
+        realloc_insert(position);
+}
+
+// 空间不足时重新配置，并在position处以args构造新元素
+template <class T, class Alloc, class Growth>
+template <class... Args>
+void vector<T, Alloc, Growth>::realloc_insert(iterator position, Args&&... args)
+{
+    const size_type old_size = size();
+    size_type len = Growth::grow(old_size, 1, sizeof(T));
+    // 以上配置原则由增长策略决定，默认为：如果原大小为0，则配置1个
+    // 如果原大小不为0，则配置原大小的两倍
+    // 前半段用来放置原数据，后半段准备用来放置新数据
+    // 配置器实际给出的区块可能更大，len随之改为真正可容纳的元素个数
+
+    if (position == finish && start != 0 && relocatable::value) {
+        // 在尾端追加且元素可逐位搬家：交给配置器的reallocate()扩充，
+        // realloc()可能原地扩充，超大区块则由mremap()搬移页表而不复制
+        T x_copy(std::forward<Args>(args)...);     // 参数可能正引用vector中的元素
+        start = data_allocator::reallocate(start, old_size, len);
+        finish = start + old_size;
+        end_of_storage = start + len;
+        Construct(finish, std::move(x_copy));
+        ++finish;
+        return;
+    }
+
+    iterator new_start = data_allocator::allocate_at_least(len);     // 实际配置
+    iterator new_position = new_start + (position - start);
+    // 先构造新元素：参数可能正引用vector中的元素，必须在搬移之前使用
+    try {
+        Construct(new_position, std::forward<Args>(args)...);
+    }
+    catch(...) {
+        data_allocator::deallocate(new_start, len);
+        throw;
+    }
+    adopt_storage(position, new_start, len, 1);
+}
+
+template <class T, class Alloc, class Growth>
+void vector<T, Alloc, Growth>::adopt_storage(iterator position, iterator new_start,
+                                             size_type len, size_type n)
+{
+    iterator new_position = new_start + (position - start);
+    iterator new_finish = new_start;
+    if (relocatable::value) {
+        // 元素可逐位搬家：插入点前后各一次memcpy，旧空间直接释放，不必逐一析构
+        relocate(start, position, new_start);
+        new_finish = relocate(position, finish, new_position + n);
+    }
     else {
-        const size_type old_size = size();
-        const size_type len = old_size != 0 ? 2 * old_size : 1;
-        iterator new_start = data_allocator::allocate(len);
-        iterator new_finish = new_start;
-        try {
-            new_finish = uninitialized_copy(start, position, new_start);
-            Construct(new_finish);
-            ++new_finish;
-            new_finish = uninitialized_copy(position, finish, new_finish);
+        try
+        {
+            // 将原vector的内容搬到新vector：move constructor不抛出异常时搬移，否则复制
+            new_finish = Uninitialized_move_if_noexcept(start, position, new_start);
+            new_finish += n;
+            // 将安插点的原内容也搬过来
+            new_finish = Uninitialized_move_if_noexcept(position, finish, new_finish);
         }
-        catch(const std::exception& e) {
-            Destroy(new_start, new_finish);
+        catch(...)
+        {
+            // commit or rollback semantics：原vector未被改动
+            if (new_finish == new_start)
+                Destroy(new_position, new_position + n);
+            else
+                Destroy(new_start, new_finish);
             data_allocator::deallocate(new_start, len);
+            throw;
         }
+        // 析构原vector
         Destroy(begin(), end());
-        data_allocator::deallocate(start, end_of_storage - start);
-        start = new_start;
-        finish = new_finish;
-        end_of_storage = new_start + len;
     }
+    // 释放原vector
+    deallocate();
+
+    // 调整迭代器，指向新的vector
+    start = new_start;
+    finish = new_finish;
+    end_of_storage = new_start + len;
 }
 
 // 从position开始，插入n个元素，元素初值为x
-template<class T>
-void vector<T>::insert(iterator position,size_type n,const T& x) {
+template <class T, class Alloc, class Growth>
+void vector<T, Alloc, Growth>::insert(iterator position,size_type n,const T& x) {
     if(n != 0) {
         if(size_type(end_of_storage-finish) >= n) {
             // 备用空间大于等于新增元素个数
@@ -277,120 +552,250 @@ void vector<T>::insert(iterator position,size_type n,const T& x) {
             iterator old_finish = finish;
             if(elems_after > n ) {
                 // 插入点之后的现有元素个数大于新增元素个数
-                uninitialized_copy(finish - n, finish, finish);
+                Uninitialized_copy(finish - n, finish, finish);
                 finish += n;    // 将vector尾端标记后移
                 copy_backward(position, old_finish - n, old_finish);
                 fill(position, position + n, x_copy);   // 从插入点开始填入新值
             }
             else{
                 // 插入点之后的现有元素个数小于等于新增元素个数
-                uninitialized_fill_n(finish, n - elems_after, x_copy);
+                Uninitialized_fill_n(finish, n - elems_after, x_copy);
                 finish += n - elems_after;
-                uninitialized_copy(position, old_finish, finish);
+                Uninitialized_copy(position, old_finish, finish);
                 finish += elems_after;
                 fill(position, old_finish, x_copy);
             }
         }
         else{
             // 备用空间小于新增元素个数，必须配置额外的内存
-            // 首先决定新长度：旧长度的两倍，或旧长度+新增元素个数
+            // 首先由增长策略决定新长度，默认为旧长度的两倍，或旧长度+新增元素个数
             const size_type old_size = size();
-            const size_type len = old_size + max(old_size, n);
-            // 以下配置新的vector空间
-            iterator new_start = data_allocator::allocate(len);
-            iterator new_finish = new_start;
-
-            // 以下首先将旧vector的插入点之前的元素复杂到新的空间
-            new_finish = uninitialized_copy(start, position, new_start);
-            // 以下再将新增元素，初值皆为n，填入新空间
-            new_finish = uninitialized_fill_n(new_finish, n, x);
-            // 以下再将旧vector的插入点之后的元素复制到新空间
-            new_finish = uninitialized_copy(position, finish, new_finish);
-
-        # ifdef __STL_USE_EXCEPTIONS
-            catch() {
-                Destroy(new_start, new_finish);
+            size_type len = Growth::grow(old_size, n, sizeof(T));
+            if (position == finish && start != 0 && relocatable::value) {
+                // 在尾端插入且元素可逐位搬家：原有元素不必移动位置，交给reallocate()扩充
+                T x_copy = x;       // x可能正是vector中的元素
+                start = data_allocator::reallocate(start, capacity(), len);
+                finish = start + old_size;
+                end_of_storage = start + len;
+                finish = Uninitialized_fill_n(finish, n, x_copy);
+                return;
+            }
+            // 以下配置新的vector空间，len改为实际可容纳的元素个数
+            iterator new_start = data_allocator::allocate_at_least(len);
+            iterator new_position = new_start + (position - start);
+
+            // 以下先将新增元素，初值皆为x，填入新空间(x可能正是vector中的元素)
+            try {
+                Uninitialized_fill_n(new_position, n, x);
+            }
+            catch(...) {
                 data_allocator::deallocate(new_start, len);
                 throw;
             }
-        # endif
-            // 以下清楚并释放旧的vector
-            Destroy(start, finish);
-            deallocate();
-            // 以下调整位置标记
-            start = new_start;
-            finish = new_finish;
-            end_of_storage = new_start + len;
+            // 以下再将旧vector插入点前后的元素搬到新空间，并释放旧的vector
+            adopt_storage(position, new_start, len, n);
+        }
+    }
+}
+
+// 插入输入迭代器的区间：元素个数无法预知，在尾端时逐一push_back，由增长策略分摊重新配置；
+// 否则先收集到临时vector，再一次搬入
+template <class T, class Alloc, class Growth>
+template <class InputIterator>
+void vector<T, Alloc, Growth>::range_insert(iterator position, InputIterator first,
+                                            InputIterator last, input_iterator_tag)
+{
+    if (position == finish) {
+        for ( ; first != last; ++first)
+            push_back(*first);
+    }
+    else {
+        vector<T, Alloc, Growth> tmp(first, last, get_allocator());
+        range_insert(position, make_move_iterator(tmp.begin()), make_move_iterator(tmp.end()),
+                     forward_iterator_tag());
+    }
+}
+
+// 插入前向迭代器的区间：先求出元素个数n，备用空间足够时就地后移，否则只重新配置一次
+template <class T, class Alloc, class Growth>
+template <class ForwardIterator>
+void vector<T, Alloc, Growth>::range_insert(iterator position, ForwardIterator first,
+                                            ForwardIterator last, forward_iterator_tag)
+{
+    if (first == last)
+        return;
+    const size_type n = distance(first, last);
+    if (size_type(end_of_storage - finish) >= n) {
+        const size_type elems_after = finish - position;
+        iterator old_finish = finish;
+        if (elems_after > n) {
+            // 插入点之后的现有元素个数大于新增元素个数
+            Uninitialized_move_if_noexcept(finish - n, finish, finish);
+            finish += n;
+            std::move_backward(position, old_finish - n, old_finish);
+            copy(first, last, position);
         }
+        else {
+            // 插入点之后的现有元素个数小于等于新增元素个数
+            ForwardIterator mid = first;
+            advance(mid, elems_after);
+            Uninitialized_copy(mid, last, finish);
+            finish += n - elems_after;
+            Uninitialized_move_if_noexcept(position, old_finish, finish);
+            finish += elems_after;
+            copy(first, mid, position);
+        }
+    }
+    else {
+        size_type len = Growth::grow(size(), n, sizeof(T));
+        iterator new_start = data_allocator::allocate_at_least(len);
+        // 先把新区间复制到新空间的插入位置，再搬移原有元素
+        try {
+            Uninitialized_copy(first, last, new_start + (position - start));
+        }
+        catch(...) {
+            data_allocator::deallocate(new_start, len);
+            throw;
+        }
+        adopt_storage(position, new_start, len, n);
+    }
+}
+
+template <class T, class Alloc, class Growth>
+void vector<T, Alloc, Growth>::assign(size_type n, const T& x)
+{
+    if (n > capacity()) {
+        vector<T, Alloc, Growth> tmp(n, x, get_allocator());
+        swap(tmp);
+    }
+    else if (n > size()) {
+        fill(begin(), end(), x);
+        finish = Uninitialized_fill_n(finish, n - size(), x);
+    }
+    else
+        erase(fill_n(begin(), n, x), end());
+}
+
+// 输入迭代器：先逐一赋值给现有元素，多出的元素再push_back
+template <class T, class Alloc, class Growth>
+template <class InputIterator>
+void vector<T, Alloc, Growth>::range_assign(InputIterator first, InputIterator last,
+                                            input_iterator_tag)
+{
+    iterator cur = begin();
+    for ( ; first != last && cur != finish; ++cur, ++first)
+        *cur = *first;
+    if (first == last)
+        erase(cur, end());
+    else
+        range_insert(end(), first, last, input_iterator_tag());
+}
+
+// 前向迭代器：先求出元素个数，容量不足时配置恰好的空间一次复制完成
+template <class T, class Alloc, class Growth>
+template <class ForwardIterator>
+void vector<T, Alloc, Growth>::range_assign(ForwardIterator first, ForwardIterator last,
+                                            forward_iterator_tag)
+{
+    const size_type len = distance(first, last);
+    if (len > capacity()) {
+        iterator tmp = allocate_and_copy(len, first, last);
+        Destroy(start, finish);
+        deallocate();
+        start = tmp;
+        finish = end_of_storage = start + len;
+    }
+    else if (size() >= len) {
+        iterator new_finish = copy(first, last, start);
+        Destroy(new_finish, finish);
+        finish = new_finish;
+    }
+    else {
+        ForwardIterator mid = first;
+        advance(mid, size());
+        copy(first, mid, start);
+        finish = Uninitialized_copy(mid, last, finish);
     }
 }
 // ==运算符重载
-template <class T>
+template <class T, class Alloc, class Growth>
 inline bool 
-operator==(vector<T>& x, vector<T>& y) 
+operator==(vector<T, Alloc, Growth>& x, vector<T, Alloc, Growth>& y) 
 {
     return x.size() == y.size()&&
         equal(x.begin(), x.end(), y.begin());
 }
 // <运算符重载
-template <class T>
+template <class T, class Alloc, class Growth>
 inline bool 
-operator< (vector<T>& x, vector<T>& y)
+operator< (vector<T, Alloc, Growth>& x, vector<T, Alloc, Growth>& y)
 {
   return lexicographical_compare(x.begin(), x.end(), 
                                  y.begin(), y.end());
 }
 // !=运算符重载
-template <class T>
+template <class T, class Alloc, class Growth>
 inline bool
-operator!=(vector<T>& x, vector<T>& y) {
+operator!=(vector<T, Alloc, Growth>& x, vector<T, Alloc, Growth>& y) {
   return !(x == y);
 }
 
 // >运算符重载
-template <class T>
+template <class T, class Alloc, class Growth>
 inline bool
-operator>(vector<T>& x, vector<T>& y) {
+operator>(vector<T, Alloc, Growth>& x, vector<T, Alloc, Growth>& y) {
   return y < x;
 }
 
 // <=运算符重载
-template <class T>
+template <class T, class Alloc, class Growth>
 inline bool
-operator<=(vector<T>& x, vector<T>& y) {
+operator<=(vector<T, Alloc, Growth>& x, vector<T, Alloc, Growth>& y) {
   return !(y < x);
 }
 
 // >=运算符重载
-template <class T>
+template <class T, class Alloc, class Growth>
 inline bool
-operator>=(vector<T>& x, vector<T>& y) {
+operator>=(vector<T, Alloc, Growth>& x, vector<T, Alloc, Growth>& y) {
   return !(x < y);
 }
 
-template <class T>
-vector<T>& vector<T>::operator=(const vector<T>& x)
+template <class T, class Alloc, class Growth>
+vector<T, Alloc, Growth>& vector<T, Alloc, Growth>::operator=(const vector<T, Alloc, Growth>& x)
 {
     if (&x != this) {
         const size_type xlen = x.size();
         if (xlen > capacity()) {
-            iterator tmp = _allocate_and_copy(xlen, x.begin(), x.end());
+            iterator tmp = allocate_and_copy(xlen, x.begin(), x.end());
             Destroy(start, finish);
-            deallocate(start, end_of_storage - start);
+            deallocate();
             start = tmp;
             end_of_storage = start + xlen;
         }
         else if (size() >= xlen) {
             iterator i = copy(x.begin(), x.end(), begin());
-            destroy(i, finish);
+            Destroy(i, finish);
         }
         else {
             copy(x.begin(), x.begin() + size(), start);
-            uninitialized_copy(x.begin() + size(), x.end(), finish);
+            Uninitialized_copy(x.begin() + size(), x.end(), finish);
         }
         finish = start + xlen;
     }
     return *this;
 }
 
-#endif
\ No newline at end of file
+// vector只保存指向堆上空间的指针与配置器，配置器可逐位复制时整个vector可逐位搬家
+template <class T, class Alloc, class Growth>
+struct is_trivially_relocatable<vector<T, Alloc, Growth> >
+    : integral_constant<bool, is_trivially_copyable<Alloc>::value> {};
+
+// 以memory_resource配置空间的vector，资源可在运行期选择
+template <class T>
+using pmr_vector = vector<T, polymorphic_alloc>;
+
+// vector<bool>的特化版本，每个元素只占1个bit
+#include "tiny_bvector.h"
+
+#endif